@@ -0,0 +1,58 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include "json_grammar.hpp"
+
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <string>
+
+using namespace parsely;
+
+namespace
+{
+auto make_input(std::size_t const records) -> std::string
+{
+    std::string input = "[";
+    for (std::size_t i = 0; i < records; ++i)
+    {
+        if (i > 0)
+            input += ",";
+        input += R"({"id":)" + std::to_string(i) + R"(,"name":"record","tags":["a","b"],"valid":true})";
+    }
+    return input + "]";
+}
+} // namespace
+
+TEST_CASE("parse vs parse_dynamic")
+{
+    using json_parser = parser<benchmark::json_grammar>;
+
+    for (std::size_t const records : {10uz, 100uz, 1000uz})
+    {
+        std::string const input = make_input(records);
+        REQUIRE(json_parser::parse(input).source_text == input);
+        REQUIRE(json_parser::parse_dynamic(input).source_text == input);
+
+        BENCHMARK("parse, " + std::to_string(input.size()) + " bytes")
+        {
+            return json_parser::parse(input);
+        };
+        BENCHMARK("parse_dynamic, " + std::to_string(input.size()) + " bytes")
+        {
+            return json_parser::parse_dynamic(input);
+        };
+
+        runtime::dynamic_tree tree;
+        runtime::vm           machine;
+        BENCHMARK("parse_dynamic (reused), " + std::to_string(input.size()) + " bytes")
+        {
+            json_parser::parse_dynamic_into(tree, machine, input);
+            return tree.valid;
+        };
+    }
+}
@@ -0,0 +1,71 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/runtime/runtime_parser.hpp>
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <string>
+
+using namespace parsely;
+
+namespace
+{
+constexpr structural::inplace_string calc_grammar = R"raw(
+    expr: unary_expr binop expr | unary_expr;
+    unary_expr: unop prim_expr | prim_expr;
+    prim_expr: "(" expr ")" | number;
+    number: digit number | digit;
+
+    digit: "0" | "1" | "2" | "3" | "4" | "5" | "6" | "7" | "8" | "9";
+    unop: "+" | "-";
+    binop: "+" | "-" | "*" | "/";
+)raw";
+
+auto make_input(std::size_t const terms) -> std::string
+{
+    std::string input;
+    for (std::size_t i = 0; i < terms; ++i)
+    {
+        if (i > 0)
+            input += "+-*/"[i % 4];
+        input += (i % 3 == 0) ? "(12*-3)" : "4567";
+    }
+    return input;
+}
+} // namespace
+
+TEST_CASE("runtime_parser vs parser")
+{
+    using static_parser = parser<calc_grammar>;
+
+    auto const runtime = runtime::runtime_parser::create(calc_grammar);
+    REQUIRE(runtime.has_value());
+
+    for (std::size_t const terms : {10uz, 100uz, 1000uz})
+    {
+        std::string const input = make_input(terms);
+        REQUIRE(static_parser::parse(input).source_text == input);
+        REQUIRE(runtime->parse(input).source_text == input);
+
+        BENCHMARK("parser, " + std::to_string(input.size()) + " bytes")
+        {
+            return static_parser::parse(input);
+        };
+        BENCHMARK("runtime_parser, " + std::to_string(input.size()) + " bytes")
+        {
+            return runtime->parse(input);
+        };
+
+        runtime::dynamic_tree tree;
+        runtime::vm           machine;
+        BENCHMARK("runtime_parser (reused), " + std::to_string(input.size()) + " bytes")
+        {
+            runtime->parse_into(tree, machine, input);
+            return tree.valid;
+        };
+    }
+}
@@ -0,0 +1,13 @@
+#
+# Elvis Parsely
+# Copyright (c) 2025 Jan Möller.
+#
+
+# Prints the sizes of the binary size benchmarks built with parse() (TYPED) and parse_dynamic() (DYNAMIC)
+file(SIZE "${TYPED}" typed_size)
+file(SIZE "${DYNAMIC}" dynamic_size)
+math(EXPR difference "${typed_size} - ${dynamic_size}")
+math(EXPR percent "100 * ${difference} / ${dynamic_size}")
+message("parse():         ${typed_size} bytes")
+message("parse_dynamic(): ${dynamic_size} bytes")
+message("difference:      ${difference} bytes (${percent}% of parse_dynamic())")
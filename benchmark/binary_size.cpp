@@ -0,0 +1,31 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+// Parses stdin with a JSON grammar. Built once with parse() and once with parse_dynamic() (if
+// ELVIS_PARSELY_DYNAMIC_TREE is defined), so the sizes of the two executables can be compared.
+
+#include "json_grammar.hpp"
+
+#include <parsely/utility/parser.hpp>
+
+#include <iostream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+using json_parser = parsely::parser<parsely::benchmark::json_grammar>;
+} // namespace
+
+auto main() -> int
+{
+    std::string const input{std::istreambuf_iterator<char>{std::cin}, std::istreambuf_iterator<char>{}};
+#ifdef ELVIS_PARSELY_DYNAMIC_TREE
+    bool const valid = json_parser::parse_dynamic(input).valid;
+#else
+    bool const valid = json_parser::parse(input).valid;
+#endif
+    return valid ? 0 : 1;
+}
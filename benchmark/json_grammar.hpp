@@ -0,0 +1,29 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef BENCHMARK_JSON_GRAMMAR_HPP
+#define BENCHMARK_JSON_GRAMMAR_HPP
+
+#include <structural/inplace_string.hpp>
+
+namespace parsely::benchmark
+{
+// A JSON grammar without whitespace and escapes, shared by the benchmarks of parse() and parse_dynamic()
+constexpr structural::inplace_string json_grammar = R"raw(
+    value: object | array | string | number | "true" | "false" | "null";
+    object: "{" members "}" | "{}";
+    members: member "," members | member;
+    member: string ":" value;
+    array: "[" elements "]" | "[]";
+    elements: value "," elements | value;
+    string: 0x22 chars 0x22;
+    chars: char chars | "";
+    char: 0x20..0x21 | 0x23..0x7E;
+    number: digit number | digit;
+    digit: 0x30..0x39;
+)raw";
+} // namespace parsely::benchmark
+
+#endif // BENCHMARK_JSON_GRAMMAR_HPP
@@ -0,0 +1,40 @@
+#
+# Elvis Parsely
+# Copyright (c) 2025 Jan Möller.
+#
+
+# Generates a parser header from a grammar file at build time and adds it to a target
+#
+#   parsely_generate_parser(<target> GRAMMAR <file> NAME <name> [NAMESPACE <namespace>] [OUTPUT <header>])
+#
+# The header defines the parser type <name> and its grammar <name>_grammar (in <namespace>, if given) and is written
+# to OUTPUT, which defaults to <name>.hpp in a directory added to the include directories of <target>. It is
+# regenerated whenever the grammar file changes. Requires the parsely_generate target
+# (ELVIS_PARSELY_ENABLE_GENERATOR).
+function(parsely_generate_parser target)
+    cmake_parse_arguments(PARSE_ARGV 1 arg "" "GRAMMAR;NAME;NAMESPACE;OUTPUT" "")
+    if (NOT arg_GRAMMAR OR NOT arg_NAME)
+        message(FATAL_ERROR "parsely_generate_parser: GRAMMAR and NAME are required")
+    endif ()
+    if (NOT TARGET parsely_generate)
+        message(FATAL_ERROR "parsely_generate_parser: Set ELVIS_PARSELY_ENABLE_GENERATOR to build parsely_generate")
+    endif ()
+    if (NOT arg_OUTPUT)
+        set(arg_OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/parsely_generated/${arg_NAME}.hpp)
+    endif ()
+
+    cmake_path(ABSOLUTE_PATH arg_GRAMMAR BASE_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
+    cmake_path(ABSOLUTE_PATH arg_OUTPUT BASE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR})
+    cmake_path(GET arg_OUTPUT PARENT_PATH output_dir)
+
+    file(MAKE_DIRECTORY ${output_dir})
+    add_custom_command(
+            OUTPUT ${arg_OUTPUT}
+            COMMAND parsely_generate ${arg_GRAMMAR} ${arg_OUTPUT} ${arg_NAME} ${arg_NAMESPACE}
+            DEPENDS parsely_generate ${arg_GRAMMAR}
+            COMMENT "Generating parser ${arg_NAME} from ${arg_GRAMMAR}"
+            VERBATIM
+    )
+    target_sources(${target} PRIVATE ${arg_OUTPUT})
+    target_include_directories(${target} PRIVATE ${output_dir})
+endfunction()
@@ -6,6 +6,9 @@
 #ifndef PARSELY_HPP
 #define PARSELY_HPP
 
+#include <parsely/runtime/runtime_parser.hpp>
+#include <parsely/utility/parse_context.hpp>
 #include <parsely/utility/parser.hpp>
+#include <parsely/utility/visitor.hpp>
 
 #endif // PARSELY_HPP
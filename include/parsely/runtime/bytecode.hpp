@@ -0,0 +1,276 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_RUNTIME_BYTECODE_HPP
+#define INCLUDE_PARSELY_RUNTIME_BYTECODE_HPP
+
+#include <parsely/runtime/grammar.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace parsely::runtime
+{
+// The instructions of the parsing virtual machine
+//
+// The machine has a current position in the input, a stack of backtrack entries and a stack of production calls. If
+// an instruction fails, the machine restores the state saved in the top backtrack entry and continues there.
+enum class opcode : std::uint8_t
+{
+    end,            // Stops successfully
+    fail,           // Fails
+    string,         // Matches strings[arg]
+    set,            // Matches a single char in sets[arg]
+    span,           // Matches as many chars in sets[arg] as possible
+    inbuilt,        // Matches inbuilts[arg]
+    test_set,       // Jumps to target if the next char isn't in sets[arg], without consuming input
+    jump,           // Jumps to target
+    choice,         // Pushes a backtrack entry resuming at target
+    commit,         // Pops the top backtrack entry and jumps to target
+    partial_commit, // Updates the top backtrack entry to the current state and jumps to target; fails if no input has
+                    // been consumed since the entry was pushed or last updated
+    call,           // Calls production arg, whose code starts at target
+    ret,            // Returns from the current production and emits its node
+};
+
+struct instruction
+{
+    opcode        op     = opcode::fail;
+    std::uint32_t arg    = 0;
+    std::uint32_t target = 0;
+
+    constexpr auto operator==(instruction const&) const -> bool = default;
+};
+
+// A compiled grammar
+struct program
+{
+    // Address of the end instruction, which is also the return address of the start production
+    static constexpr std::uint32_t s_end_address = 0;
+    // Address of a fail instruction
+    static constexpr std::uint32_t s_fail_address = 1;
+
+    std::vector<instruction>      code;
+    std::vector<std::string>      strings;
+    std::vector<char_class>       sets;
+    std::vector<inbuilt_function> inbuilts;
+    std::vector<std::string>      symbols;      // Symbol of each production
+    std::vector<std::uint32_t>    entries;      // Address of the code of each production
+    bool                          utf8 = false; // True if inputs must be valid UTF-8
+};
+
+namespace detail
+{
+class compiler
+{
+  public:
+    constexpr explicit compiler(grammar const& g)
+        : m_grammar(g)
+        , m_info(analyze(g))
+    {
+    }
+
+    constexpr auto compile() && -> program
+    {
+        emit(opcode::end);
+        emit(opcode::fail);
+
+        for (production const& p : m_grammar.productions)
+        {
+            m_program.symbols.push_back(p.symbol);
+            m_program.entries.push_back(address());
+            emit_expression(p.expression);
+            emit(opcode::ret);
+        }
+
+        for (instruction& i : m_program.code)
+        {
+            if (i.op == opcode::call)
+                i.target = m_program.entries[i.arg];
+        }
+        return std::move(m_program);
+    }
+
+  private:
+    grammar const&               m_grammar;
+    std::vector<expression_info> m_info;
+    program                      m_program;
+
+    [[nodiscard]] constexpr auto address() const -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(m_program.code.size());
+    }
+
+    constexpr auto emit(opcode const op, std::uint32_t const arg = 0, std::uint32_t const target = 0) -> std::uint32_t
+    {
+        m_program.code.push_back(instruction{.op = op, .arg = arg, .target = target});
+        return address() - 1;
+    }
+
+    constexpr void patch(std::uint32_t const at) { m_program.code[at].target = address(); }
+
+    constexpr auto add_set(char_class const& chars) -> std::uint32_t
+    {
+        for (std::size_t i = 0; i < m_program.sets.size(); ++i)
+        {
+            if (m_program.sets[i] == chars)
+                return static_cast<std::uint32_t>(i);
+        }
+        m_program.sets.push_back(chars);
+        return static_cast<std::uint32_t>(m_program.sets.size() - 1);
+    }
+
+    // Returns the chars matched by expr if it always matches exactly one of them
+    [[nodiscard]] constexpr auto single_char_class(std::size_t const expr) const -> std::optional<char_class>
+    {
+        expression const& e = m_grammar.expressions[expr];
+        switch (e.kind)
+        {
+        case expression_kind::terminal:
+            if (e.text.size() != 1)
+                return std::nullopt;
+            return m_info[expr].first;
+        case expression_kind::char_class:
+            return e.chars;
+        case expression_kind::alt:
+        {
+            char_class chars;
+            for (std::size_t const child : e.children)
+            {
+                auto const child_chars = single_char_class(child);
+                if (!child_chars)
+                    return std::nullopt;
+                chars |= *child_chars;
+            }
+            return chars;
+        }
+        default:
+            return std::nullopt;
+        }
+    }
+
+    constexpr void emit_expression(std::size_t const expr)
+    {
+        if (auto const chars = single_char_class(expr))
+        {
+            emit(opcode::set, add_set(*chars));
+            return;
+        }
+
+        expression const& e = m_grammar.expressions[expr];
+        switch (e.kind)
+        {
+        case expression_kind::terminal:
+            if (!e.text.empty())
+            {
+                m_program.strings.push_back(e.text);
+                emit(opcode::string, static_cast<std::uint32_t>(m_program.strings.size() - 1));
+            }
+            break;
+        case expression_kind::nonterminal:
+            emit(opcode::call, static_cast<std::uint32_t>(e.production));
+            break;
+        case expression_kind::seq:
+            for (std::size_t const child : e.children)
+                emit_expression(child);
+            break;
+        case expression_kind::alt:
+            emit_alt(e);
+            break;
+        case expression_kind::rep:
+            emit_rep(e);
+            break;
+        case expression_kind::char_class:
+            emit(opcode::set, add_set(e.chars));
+            break;
+        case expression_kind::inbuilt:
+            m_program.utf8 = m_program.utf8 || e.utf8;
+            m_program.inbuilts.push_back(e.inbuilt);
+            emit(opcode::inbuilt, static_cast<std::uint32_t>(m_program.inbuilts.size() - 1));
+            break;
+        }
+    }
+
+    // Alternatives that can't match empty input are guarded by a FIRST set test, so they are skipped without
+    // pushing a backtrack entry if the next char can't start them. If all alternatives are guarded and their FIRST sets
+    // are disjoint, the next char predicts the only alternative that can match, and no backtracking is required.
+    constexpr void emit_alt(expression const& e)
+    {
+        bool predictive = true;
+        char_class seen;
+        for (std::size_t const child : e.children)
+        {
+            predictive = predictive && !m_info[child].nullable && !seen.intersects(m_info[child].first);
+            seen |= m_info[child].first;
+        }
+
+        std::vector<std::uint32_t> exits;
+        for (std::size_t i = 0; i < e.children.size(); ++i)
+        {
+            std::size_t const child = e.children[i];
+            bool const        last  = i + 1 == e.children.size();
+            bool const        guard = !m_info[child].nullable;
+
+            std::uint32_t const test = guard ? emit(opcode::test_set, add_set(m_info[child].first)) : 0;
+            if (last)
+            {
+                if (guard)
+                    m_program.code[test].target = program::s_fail_address;
+                emit_expression(child);
+            }
+            else if (predictive)
+            {
+                emit_expression(child);
+                exits.push_back(emit(opcode::jump));
+                patch(test);
+            }
+            else
+            {
+                std::uint32_t const choice = emit(opcode::choice);
+                emit_expression(child);
+                exits.push_back(emit(opcode::commit));
+                patch(choice);
+                if (guard)
+                    patch(test);
+            }
+        }
+        for (std::uint32_t const exit : exits)
+            patch(exit);
+    }
+
+    // Repetitions of single chars are matched by a span instruction. All other repetitions loop until their element
+    // fails or matches empty input.
+    constexpr void emit_rep(expression const& e)
+    {
+        std::size_t const element = e.children.front();
+        if (auto const chars = single_char_class(element))
+        {
+            emit(opcode::span, add_set(*chars));
+            return;
+        }
+
+        std::uint32_t const choice = emit(opcode::choice);
+        std::uint32_t const loop   = address();
+        emit_expression(element);
+        emit(opcode::partial_commit, 0, loop);
+        patch(choice);
+    }
+};
+} // namespace detail
+
+// Compiles a grammar into a program for the parsing virtual machine
+//
+// The grammar must not be left recursive.
+constexpr auto compile(grammar const& g) -> program
+{
+    return detail::compiler(g).compile();
+}
+} // namespace parsely::runtime
+
+#endif // INCLUDE_PARSELY_RUNTIME_BYTECODE_HPP
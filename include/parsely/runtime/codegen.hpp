@@ -0,0 +1,238 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_RUNTIME_CODEGEN_HPP
+#define INCLUDE_PARSELY_RUNTIME_CODEGEN_HPP
+
+#include <parsely/runtime/grammar.hpp>
+#include <parsely/runtime/grammar_loader.hpp>
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_parser.hpp>
+
+#include <cctype>
+#include <expected>
+#include <format>
+#include <string>
+#include <string_view>
+
+namespace parsely::runtime
+{
+// Options of generate_source
+struct generator_options
+{
+    std::string name;           // Name of the generated parser type
+    std::string namespace_name; // Namespace of the generated code, or empty for the global namespace
+    std::string source;         // Description of where the grammar came from, mentioned in a comment
+};
+
+namespace detail
+{
+// Returns text as a C++ string literal
+inline auto quote(std::string_view const text) -> std::string
+{
+    std::string result = "\"";
+    for (char const c : text)
+    {
+        auto const u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (u < 0x20 || u >= 0x7F)
+            result += std::format("\\{:03o}", u); // Octal escapes end after three digits, unlike hex escapes
+        else
+            result += c;
+    }
+    result += '"';
+    return result;
+}
+
+// Returns the name of the constant in parsely::detail that an inbuilt of a grammar description is matched by, or an
+// empty string if there is none
+//
+// Mirrors structuralizer<grammar_parse_tree_node_inbuilt>.
+constexpr auto inbuilt_constant(std::string_view const name) -> std::string_view
+{
+    if (name == "letter")
+        return "inbuilt_letter";
+    if (name == "digit")
+        return "inbuilt_decimal_digit";
+    if (name == "space")
+        return "inbuilt_white_space";
+    if (name == "eoi")
+        return "inbuilt_eoi";
+    if (name == "string")
+        return "inbuilt_string";
+    return {};
+}
+
+// Converts the parse tree of a grammar description into C++ source that builds the same grammar as parsely::parser
+//
+// The source is an expression of calls to the functions of grammar_ast.hpp, which are looked up unqualified. Each
+// node is converted like by its structuralizer (see grammar_parser.hpp), so both grammars match the same inputs and
+// have the same parse tree shape.
+class grammar_writer
+{
+  public:
+    static auto write_grammar(auto const& tree) -> std::string
+    {
+        auto const& root = *tree;
+        std::string out  = "make_grammar(\n";
+        out += write_production(root.template get<1>());
+        for (auto const& more : root.template get<2>().node_repetitions)
+        {
+            out += ",\n";
+            out += write_production(more.template get<1>());
+        }
+        out += ')';
+        return out;
+    }
+
+  private:
+    static auto write_production(auto const& node) -> std::string
+    {
+        return std::format("            make_production({}, {})",
+                           quote(node->template get<0>().source_text),
+                           write_expression(node->template get<4>()));
+    }
+
+    // Writes an expression node, which consists of a single alt_expr node
+    static auto write_expression(auto const& node) -> std::string
+    {
+        auto const& alt  = **node;
+        auto const& more = alt.template get<1>().node_repetitions;
+        if (more.empty())
+            return write_seq(alt.template get<0>());
+
+        std::string out = "make_alt_expr(" + write_seq(alt.template get<0>());
+        for (auto const& m : more)
+            out += ", " + write_seq(m.template get<3>());
+        return out + ')';
+    }
+
+    static auto write_seq(auto const& node) -> std::string
+    {
+        auto const& seq  = *node;
+        auto const& more = seq.template get<1>().node_repetitions;
+        if (more.empty())
+            return write_prim(seq.template get<0>());
+
+        std::string out = "make_seq_expr(" + write_prim(seq.template get<0>());
+        for (auto const& m : more)
+            out += ", " + write_prim(m.template get<1>());
+        return out + ')';
+    }
+
+    static auto write_prim(auto const& node) -> std::string
+    {
+        auto const& prim = *node;
+        switch (prim.index())
+        {
+        case 0:
+            return write_expression(prim.template get<0>()->template get<1>());
+        case 1:
+            return write_terminal(prim.template get<1>());
+        case 2:
+        {
+            auto const& range = prim.template get<2>();
+            return write_byte_range("byte_range", range->template get<0>(), range->template get<2>());
+        }
+        case 3:
+        {
+            // Nonterminals spelled like byte literals are single bytes (see is_byte_literal)
+            auto const& nonterminal = prim.template get<3>();
+            if (parsely::detail::is_byte_literal(nonterminal.source_text))
+                return write_byte_range("byte", nonterminal, nonterminal);
+            return std::format("make_nonterminal_expr({})", quote(nonterminal.source_text));
+        }
+        case 4:
+            return "inbuilt_any";
+        case 5:
+            return std::string{inbuilt_constant(prim.template get<5>()->template get<1>().source_text)};
+        default:
+            return write_operator_table(prim.template get<6>());
+        }
+    }
+
+    static auto write_terminal(auto const& node) -> std::string
+    {
+        return std::format("make_terminal_expr({})", quote(node->template get<1>().source_text));
+    }
+
+    static auto write_byte_range(std::string_view const name, auto const& first, auto const& last) -> std::string
+    {
+        return std::format("make_inbuilt_expr(\"{}\", byte_range{{.first = {:#04x}, .last = {:#04x}}})",
+                           name,
+                           parsely::detail::byte_literal_value(first.source_text),
+                           parsely::detail::byte_literal_value(last.source_text));
+    }
+
+    static auto write_operator_table(auto const& node) -> std::string
+    {
+        auto const write_level = [](auto const& level)
+        {
+            bool const  right_associative = level->template get<0>()->index() == 1;
+            std::string out               = std::format("make_operator_level({}, {}",
+                                                        right_associative,
+                                                        write_terminal(level->template get<2>()));
+            for (auto const& m : level->template get<3>().node_repetitions)
+                out += ", " + write_terminal(m.template get<1>());
+            return out + ')';
+        };
+
+        auto const& table = *node;
+        std::string out   = "make_operator_expr(" + write_prim(table.template get<4>());
+        out += ", " + write_level(table.template get<8>());
+        for (auto const& m : table.template get<9>().node_repetitions)
+            out += ", " + write_level(m.template get<3>());
+        return out + ')';
+    }
+};
+} // namespace detail
+
+// Generates a C++ header that defines a parser for the grammar with the given description
+//
+// The header defines options.name as a parsely::basic_parser, so it has the same API, parse tree types and policies as
+// a parsely::parser of the description. Its grammar is written out as calls to the functions of grammar_ast.hpp, so
+// including the header doesn't parse the description or structuralize its parse tree, which dominate the compile time
+// of large grammars. Fails like load_grammar if the description is invalid.
+inline auto generate_source(std::string_view const description, generator_options const& options)
+    -> std::expected<std::string, grammar_error>
+{
+    if (auto const loaded = load_grammar(description); !loaded)
+        return std::unexpected(loaded.error());
+
+    std::string const grammar_name = options.name + "_grammar";
+
+    std::string guard = "PARSELY_GENERATED_";
+    for (char const c : options.namespace_name.empty() ? options.name : options.namespace_name + "_" + options.name)
+        guard += std::isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(std::toupper(c)) : '_';
+    guard += "_HPP";
+
+    std::string out = "//\n// Generated by parsely_generate";
+    if (!options.source.empty())
+        out += " from " + options.source;
+    out += ". Do not edit.\n//\n\n";
+    out += std::format("#ifndef {0}\n#define {0}\n\n", guard);
+    out += "#include <parsely/utility/grammar_ast.hpp>\n#include <parsely/utility/parser.hpp>\n\n";
+    if (!options.namespace_name.empty())
+        out += std::format("namespace {}\n{{\n", options.namespace_name);
+
+    out += std::format("struct {}\n{{\n", grammar_name);
+    out += "    static constexpr auto grammar = []\n    {\n";
+    out += "        using namespace parsely::detail;\n";
+    auto const tree = parsely::detail::grammar_parser<"">::parse(description);
+    out += "        return " + detail::grammar_writer::write_grammar(tree) + ";\n    }();\n};\n\n";
+
+    out += std::format("using {} = parsely::basic_parser<{}>;\n", options.name, grammar_name);
+    if (!options.namespace_name.empty())
+        out += std::format("}} // namespace {}\n", options.namespace_name);
+    out += std::format("\n#endif // {}\n", guard);
+    return out;
+}
+} // namespace parsely::runtime
+
+#endif // INCLUDE_PARSELY_RUNTIME_CODEGEN_HPP
@@ -0,0 +1,497 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_RUNTIME_GRAMMAR_HPP
+#define INCLUDE_PARSELY_RUNTIME_GRAMMAR_HPP
+
+#include <parsely/utility/source_index.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace parsely::runtime
+{
+// A set of chars, stored as a bitmap
+class char_class
+{
+  public:
+    constexpr void insert(unsigned char const c) { m_bits[c / 64] |= std::uint64_t{1} << (c % 64); }
+
+    [[nodiscard]] constexpr auto contains(unsigned char const c) const -> bool
+    {
+        return (m_bits[c / 64] & (std::uint64_t{1} << (c % 64))) != 0;
+    }
+
+    [[nodiscard]] constexpr auto empty() const -> bool { return m_bits == std::array<std::uint64_t, 4>{}; }
+
+    [[nodiscard]] constexpr auto intersects(char_class const& other) const -> bool
+    {
+        for (std::size_t i = 0; i < m_bits.size(); ++i)
+        {
+            if ((m_bits[i] & other.m_bits[i]) != 0)
+                return true;
+        }
+        return false;
+    }
+
+    constexpr auto operator|=(char_class const& other) -> char_class&
+    {
+        for (std::size_t i = 0; i < m_bits.size(); ++i)
+            m_bits[i] |= other.m_bits[i];
+        return *this;
+    }
+
+    // Returns the class containing all chars for which pred returns true
+    static constexpr auto from_predicate(auto pred) -> char_class
+    {
+        char_class result;
+        for (unsigned c = 0; c < 256; ++c)
+        {
+            if (pred(static_cast<char>(c)))
+                result.insert(static_cast<unsigned char>(c));
+        }
+        return result;
+    }
+
+    // Returns the class containing all chars
+    static constexpr auto all() -> char_class
+    {
+        char_class result;
+        result.m_bits.fill(~std::uint64_t{0});
+        return result;
+    }
+
+    constexpr auto operator==(char_class const&) const -> bool = default;
+
+  private:
+    std::array<std::uint64_t, 4> m_bits{};
+};
+
+// The kinds of runtime grammar expressions
+enum class expression_kind : std::uint8_t
+{
+    terminal,    // Matches text literally
+    nonterminal, // Matches the production with index production
+    seq,         // Matches all children in order
+    alt,         // Matches the first matching child
+    rep,         // Matches its only child as often as possible
+    char_class,  // Matches a single char contained in chars
+    inbuilt,     // Matches the prefix length returned by inbuilt
+};
+
+// Matches a prefix of the input and returns its length, or std::nullopt if there is no match
+using inbuilt_function = auto (*)(std::string_view) -> std::optional<std::size_t>;
+
+// An expression of a runtime grammar
+struct expression
+{
+    expression_kind          kind = expression_kind::terminal;
+    std::string              text;                 // Literal of terminals, symbol of nonterminals
+    std::size_t              production = 0;       // Production matched by nonterminals
+    std::vector<std::size_t> children;             // Indices of the sub-expressions of seq, alt and rep
+    char_class               chars;                // Chars matched by char_class
+    inbuilt_function         inbuilt = nullptr;    // Function called by inbuilt
+    bool                     utf8    = false;      // True if inbuilt matches UTF-8 encoded codepoints
+
+    constexpr auto operator==(expression const&) const -> bool = default;
+};
+
+// A production of a runtime grammar
+struct production
+{
+    std::string symbol;
+    std::size_t expression = 0; // Index of the expression of the production
+
+    constexpr auto operator==(production const&) const -> bool = default;
+};
+
+// A grammar that is only known at runtime
+//
+// Expressions are stored in a flat array and refer to each other by index.
+struct grammar
+{
+    std::vector<production> productions;
+    std::vector<expression> expressions;
+
+    // Appends an expression and returns its index
+    constexpr auto add(expression expr) -> std::size_t
+    {
+        expressions.push_back(std::move(expr));
+        return expressions.size() - 1;
+    }
+
+    // Returns the index of the production named symbol
+    [[nodiscard]] constexpr auto find_production(std::string_view const symbol) const -> std::optional<std::size_t>
+    {
+        for (std::size_t i = 0; i < productions.size(); ++i)
+        {
+            if (productions[i].symbol == symbol)
+                return i;
+        }
+        return std::nullopt;
+    }
+
+    constexpr auto operator==(grammar const&) const -> bool = default;
+};
+
+// Adds an expression matching an operator table like `operand (operator operand)*`, trying longer operators first
+//
+// Runtime grammars have no operator tables, so the operands and operators are matched in input order without being
+// ordered by precedence. first_operand and operand must be distinct expressions matching the operand.
+constexpr auto add_operator_table(grammar&                 g,
+                                  std::size_t const        first_operand,
+                                  std::size_t const        operand,
+                                  std::vector<std::string> operators) -> std::size_t
+{
+    // Insertion sort keeps operators of the same length in the order they are listed
+    for (std::size_t i = 1; i < operators.size(); ++i)
+    {
+        for (std::size_t j = i; j > 0 && operators[j - 1].size() < operators[j].size(); --j)
+            std::swap(operators[j - 1], operators[j]);
+    }
+
+    expression alternatives{.kind = expression_kind::alt};
+    for (std::string& op : operators)
+        alternatives.children.push_back(g.add(expression{.kind = expression_kind::terminal, .text = std::move(op)}));
+
+    std::size_t const next = g.add(expression{
+        .kind     = expression_kind::seq,
+        .children = {g.add(std::move(alternatives)), operand},
+    });
+    std::size_t const more = g.add(expression{.kind = expression_kind::rep, .children = {next}});
+    return g.add(expression{.kind = expression_kind::seq, .children = {first_operand, more}});
+}
+
+// Describes why a grammar couldn't be loaded
+struct grammar_error
+{
+    std::size_t     offset = 0; // Offset into the grammar description
+    source_location location;   // Line and column of offset
+    std::string     message;
+};
+
+// Properties of an expression that allow parsing it predictively
+struct expression_info
+{
+    bool       nullable = false; // True if the expression may match without consuming input
+    char_class first;            // Chars that a non-empty match may start with
+};
+
+// Computes nullability and FIRST sets of all expressions of a grammar
+//
+// The result is conservative: Inbuilts may start with any char. They are nullable if they match the empty input, since
+// the inbuilts of grammar descriptions only match the empty string at the end of the input (see find_inbuilt).
+constexpr auto analyze(grammar const& g) -> std::vector<expression_info>
+{
+    std::vector<expression_info> info(g.expressions.size());
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (std::size_t i = 0; i < g.expressions.size(); ++i)
+        {
+            expression const& expr = g.expressions[i];
+            expression_info   next;
+            switch (expr.kind)
+            {
+            case expression_kind::terminal:
+                next.nullable = expr.text.empty();
+                if (!expr.text.empty())
+                    next.first.insert(static_cast<unsigned char>(expr.text.front()));
+                break;
+            case expression_kind::nonterminal:
+                next = info[g.productions[expr.production].expression];
+                break;
+            case expression_kind::seq:
+                next.nullable = true;
+                for (std::size_t const child : expr.children)
+                {
+                    next.first |= info[child].first;
+                    if (!info[child].nullable)
+                    {
+                        next.nullable = false;
+                        break;
+                    }
+                }
+                break;
+            case expression_kind::alt:
+                for (std::size_t const child : expr.children)
+                {
+                    next.nullable = next.nullable || info[child].nullable;
+                    next.first |= info[child].first;
+                }
+                break;
+            case expression_kind::rep:
+                next.nullable = true;
+                next.first    = info[expr.children.front()].first;
+                break;
+            case expression_kind::char_class:
+                next.first = expr.chars;
+                break;
+            case expression_kind::inbuilt:
+                next.nullable = expr.inbuilt(std::string_view{}).has_value();
+                next.first    = char_class::all();
+                break;
+            }
+
+            if (next.nullable != info[i].nullable || next.first != info[i].first)
+            {
+                info[i] = next;
+                changed = true;
+            }
+        }
+    }
+    return info;
+}
+
+namespace detail
+{
+// Collects the productions that may be called by an expression before any input is consumed
+constexpr void collect_left_calls(grammar const&                      g,
+                                  std::vector<expression_info> const& info,
+                                  std::size_t const                   expr,
+                                  std::vector<std::size_t>&           calls)
+{
+    expression const& e = g.expressions[expr];
+    switch (e.kind)
+    {
+    case expression_kind::nonterminal:
+        calls.push_back(e.production);
+        break;
+    case expression_kind::seq:
+        for (std::size_t const child : e.children)
+        {
+            collect_left_calls(g, info, child, calls);
+            if (!info[child].nullable)
+                break;
+        }
+        break;
+    case expression_kind::alt:
+    case expression_kind::rep:
+        for (std::size_t const child : e.children)
+            collect_left_calls(g, info, child, calls);
+        break;
+    default:
+        break;
+    }
+}
+} // namespace detail
+
+// Returns the index of a production that is left recursive, if there is one
+constexpr auto find_left_recursion(grammar const& g, std::vector<expression_info> const& info)
+    -> std::optional<std::size_t>
+{
+    std::vector<std::vector<std::size_t>> edges(g.productions.size());
+    for (std::size_t p = 0; p < g.productions.size(); ++p)
+        detail::collect_left_calls(g, info, g.productions[p].expression, edges[p]);
+
+    // Depth-first search for a cycle
+    enum class state : std::uint8_t
+    {
+        unvisited,
+        active,
+        done
+    };
+    std::vector<state> states(g.productions.size(), state::unvisited);
+    for (std::size_t root = 0; root < g.productions.size(); ++root)
+    {
+        if (states[root] != state::unvisited)
+            continue;
+
+        std::vector<std::pair<std::size_t, std::size_t>> stack{{root, 0}}; // (production, next edge)
+        states[root] = state::active;
+        while (!stack.empty())
+        {
+            auto& [p, next] = stack.back();
+            if (next == edges[p].size())
+            {
+                states[p] = state::done;
+                stack.pop_back();
+                continue;
+            }
+            std::size_t const q = edges[p][next++];
+            if (states[q] == state::active)
+                return q;
+            if (states[q] == state::unvisited)
+            {
+                states[q] = state::active;
+                stack.emplace_back(q, 0);
+            }
+        }
+    }
+    return std::nullopt;
+}
+namespace detail
+{
+// Checks whether the expressions at indices a and b match the same inputs because they have the same structure
+constexpr auto same_expression(grammar const& g, std::size_t const a, std::size_t const b) -> bool
+{
+    if (a == b)
+        return true;
+
+    expression const& x = g.expressions[a];
+    expression const& y = g.expressions[b];
+    if (x.kind != y.kind || x.text != y.text || x.production != y.production || x.chars != y.chars
+        || x.inbuilt != y.inbuilt || x.children.size() != y.children.size())
+        return false;
+    for (std::size_t i = 0; i < x.children.size(); ++i)
+    {
+        if (!same_expression(g, x.children[i], y.children[i]))
+            return false;
+    }
+    return true;
+}
+
+// Returns the elements of the expression at index expr, which is treated as a sequence
+constexpr auto elements_of(grammar const& g, std::size_t const expr) -> std::vector<std::size_t>
+{
+    if (g.expressions[expr].kind == expression_kind::seq)
+        return g.expressions[expr].children;
+    return {expr};
+}
+
+// Calls f with each node of the expression tree at index expr, without following nonterminals
+template<typename F>
+constexpr void visit_expression(grammar const& g, std::size_t const expr, F const& f)
+{
+    f(g.expressions[expr]);
+    for (std::size_t const child : g.expressions[expr].children)
+        visit_expression(g, child, f);
+}
+
+// Checks whether the production at index p may call itself
+constexpr auto is_recursive(grammar const& g, std::size_t const p) -> bool
+{
+    std::vector<bool>        visited(g.productions.size());
+    std::vector<std::size_t> pending{p};
+    while (!pending.empty())
+    {
+        std::size_t const current = pending.back();
+        pending.pop_back();
+        bool found = false;
+        visit_expression(g,
+                         g.productions[current].expression,
+                         [&](expression const& e)
+                         {
+                             if (e.kind != expression_kind::nonterminal)
+                                 return;
+                             found = found || e.production == p;
+                             if (!visited[e.production])
+                             {
+                                 visited[e.production] = true;
+                                 pending.push_back(e.production);
+                             }
+                         });
+        if (found)
+            return true;
+    }
+    return false;
+}
+
+// Replaces nonterminals by the expressions of their productions if these are small or called only once
+//
+// Recursive productions are kept. Inlined expressions are shared rather than copied, so the grammar doesn't grow.
+constexpr void inline_productions(grammar& g)
+{
+    constexpr std::size_t small_size = 8; // Expressions of at most this many nodes are inlined into every caller
+
+    std::vector<std::size_t> calls(g.productions.size());
+    for (production const& p : g.productions)
+    {
+        visit_expression(g,
+                         p.expression,
+                         [&](expression const& e)
+                         {
+                             if (e.kind == expression_kind::nonterminal)
+                                 ++calls[e.production];
+                         });
+    }
+
+    std::vector<bool> inlined(g.productions.size());
+    for (std::size_t p = 0; p < g.productions.size(); ++p)
+    {
+        std::size_t size = 0;
+        visit_expression(g, g.productions[p].expression, [&](expression const&) { ++size; });
+        inlined[p] = (calls[p] == 1 || size <= small_size) && !is_recursive(g, p);
+    }
+
+    for (expression& e : g.expressions)
+    {
+        while (e.kind == expression_kind::nonterminal && inlined[e.production])
+            e = g.expressions[g.productions[e.production].expression];
+    }
+}
+
+// Adds a sequence of elements, or returns the only element
+constexpr auto add_sequence(grammar& g, std::vector<std::size_t> elements) -> std::size_t
+{
+    if (elements.size() == 1)
+        return elements.front();
+    return g.add(expression{.kind = expression_kind::seq, .children = std::move(elements)});
+}
+} // namespace detail
+
+// Rewrites a grammar so that it matches the same inputs with fewer production calls
+//
+// Productions that aren't recursive are inlined if they are small or called only once. Productions of the form
+// `p: a p | ""` become `a*`, and productions of the form `p: b r p | b` become `b (r b)*`, where a, b and r may be
+// sequences. The repetitions match without nesting calls, and repetitions of single chars are matched in a tight loop.
+// Parse trees lose nodes, though, so this is only useful for recognizing inputs.
+constexpr void optimize_for_recognition(grammar& g)
+{
+    detail::inline_productions(g);
+
+    for (std::size_t p = 0; p < g.productions.size(); ++p)
+    {
+        expression const& alt = g.expressions[g.productions[p].expression];
+        if (alt.kind != expression_kind::alt || alt.children.size() != 2)
+            continue;
+
+        std::size_t const        other     = alt.children[1];
+        std::vector<std::size_t> recursive = detail::elements_of(g, alt.children[0]);
+        expression const&        call      = g.expressions[recursive.back()];
+        if (recursive.size() < 2 || call.kind != expression_kind::nonterminal || call.production != p)
+            continue;
+        recursive.pop_back();
+
+        expression const& base_expr = g.expressions[other];
+        if (base_expr.kind == expression_kind::terminal && base_expr.text.empty())
+        {
+            std::size_t const element   = detail::add_sequence(g, recursive);
+            g.productions[p].expression = g.add(expression{.kind = expression_kind::rep, .children = {element}});
+            continue;
+        }
+
+        std::vector<std::size_t> const base = detail::elements_of(g, other);
+        if (base.size() > recursive.size())
+            continue;
+        bool is_prefix = true;
+        for (std::size_t i = 0; i < base.size(); ++i)
+            is_prefix = is_prefix && detail::same_expression(g, base[i], recursive[i]);
+        if (!is_prefix)
+            continue;
+
+        std::vector<std::size_t> step(recursive.begin() + static_cast<std::ptrdiff_t>(base.size()), recursive.end());
+        step.insert(step.end(), base.begin(), base.end());
+        std::size_t const element = detail::add_sequence(g, std::move(step));
+
+        std::vector<std::size_t> sequence = base;
+        sequence.push_back(g.add(expression{.kind = expression_kind::rep, .children = {element}}));
+        g.productions[p].expression = detail::add_sequence(g, std::move(sequence));
+    }
+
+    // Productions that were rewritten may no longer be recursive
+    detail::inline_productions(g);
+}
+} // namespace parsely::runtime
+
+#endif // INCLUDE_PARSELY_RUNTIME_GRAMMAR_HPP
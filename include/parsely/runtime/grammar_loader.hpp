@@ -0,0 +1,256 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_RUNTIME_GRAMMAR_LOADER_HPP
+#define INCLUDE_PARSELY_RUNTIME_GRAMMAR_LOADER_HPP
+
+#include <parsely/runtime/grammar.hpp>
+#include <parsely/runtime/inbuilts.hpp>
+#include <parsely/utility/grammar_parser.hpp>
+
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace parsely::runtime
+{
+namespace detail
+{
+// Converts the parse tree of a grammar description into a runtime grammar
+//
+// The description is parsed with the same rules that parsely::parser uses for compile-time grammars.
+class grammar_loader
+{
+  public:
+    constexpr explicit grammar_loader(std::string_view const description)
+        : m_description(description)
+    {
+    }
+
+    constexpr auto load() && -> std::expected<grammar, grammar_error>
+    {
+        auto const tree = parsely::detail::grammar_parser<"">::parse(m_description);
+        if (!tree)
+            return std::unexpected(grammar_error{.offset = tree.source_text.size(), .message = "Invalid grammar"});
+
+        auto const& root = *tree;
+        load_production(root.template get<1>());
+        for (auto const& more : root.template get<2>().node_repetitions)
+            load_production(more.template get<1>());
+        if (m_error)
+            return std::unexpected(std::move(*m_error));
+
+        for (std::size_t i = 0; i < m_grammar.expressions.size(); ++i)
+        {
+            expression& expr = m_grammar.expressions[i];
+            if (expr.kind != expression_kind::nonterminal)
+                continue;
+            auto const production = m_grammar.find_production(expr.text);
+            if (!production)
+                return std::unexpected(grammar_error{.offset = m_offsets[i], .message = "Unknown symbol " + expr.text});
+            expr.production = *production;
+        }
+
+        if (auto const p = find_left_recursion(m_grammar, analyze(m_grammar)))
+        {
+            return std::unexpected(grammar_error{
+                .offset  = m_production_offsets[*p],
+                .message = "Left recursive production " + m_grammar.productions[*p].symbol,
+            });
+        }
+        return std::move(m_grammar);
+    }
+
+  private:
+    std::string_view             m_description;
+    grammar                      m_grammar;
+    std::vector<std::size_t>     m_offsets;            // Offset into the description of each expression
+    std::vector<std::size_t>     m_production_offsets; // Offset into the description of each production
+    std::optional<grammar_error> m_error;
+
+    [[nodiscard]] constexpr auto offset_of(std::string_view const text) const -> std::size_t
+    {
+        return static_cast<std::size_t>(text.data() - m_description.data());
+    }
+
+    constexpr auto add(expression expr, std::string_view const source_text) -> std::size_t
+    {
+        m_offsets.push_back(offset_of(source_text));
+        return m_grammar.add(std::move(expr));
+    }
+
+    constexpr void load_production(auto const& node)
+    {
+        auto const& symbol = node->template get<0>().source_text;
+        if (m_grammar.find_production(symbol))
+        {
+            if (!m_error)
+            {
+                m_error = grammar_error{
+                    .offset  = offset_of(symbol),
+                    .message = "Duplicate production " + std::string{symbol},
+                };
+            }
+            return;
+        }
+        m_production_offsets.push_back(offset_of(symbol));
+        m_grammar.productions.push_back(production{.symbol = std::string{symbol}});
+        std::size_t const index = m_grammar.productions.size() - 1;
+
+        std::size_t const expr                  = load_expression(node->template get<4>());
+        m_grammar.productions[index].expression = expr;
+    }
+
+    // Loads an expression node, which consists of a single alt_expr node
+    constexpr auto load_expression(auto const& node) -> std::size_t
+    {
+        auto const& alt  = **node;
+        auto const& more = alt.template get<1>().node_repetitions;
+        if (more.empty())
+            return load_seq(alt.template get<0>());
+
+        expression result{.kind = expression_kind::alt};
+        result.children.push_back(load_seq(alt.template get<0>()));
+        for (auto const& m : more)
+            result.children.push_back(load_seq(m.template get<3>()));
+        return add(std::move(result), node.source_text);
+    }
+
+    constexpr auto load_seq(auto const& node) -> std::size_t
+    {
+        auto const& seq  = *node;
+        auto const& more = seq.template get<1>().node_repetitions;
+        if (more.empty())
+            return load_prim(seq.template get<0>());
+
+        expression result{.kind = expression_kind::seq};
+        result.children.push_back(load_prim(seq.template get<0>()));
+        for (auto const& m : more)
+            result.children.push_back(load_prim(m.template get<1>()));
+        return add(std::move(result), node.source_text);
+    }
+
+    constexpr auto load_prim(auto const& node) -> std::size_t
+    {
+        auto const& prim = *node;
+        switch (prim.index())
+        {
+        case 0:
+            return load_expression(prim.template get<0>()->template get<1>());
+        case 1:
+        {
+            auto const& terminal = prim.template get<1>();
+            return add(expression{.kind = expression_kind::terminal,
+                                  .text = std::string{terminal->template get<1>().source_text}},
+                       terminal.source_text);
+        }
+        case 2:
+        {
+            auto const& range = prim.template get<2>();
+            return add_byte_range(byte_value(range->template get<0>()), byte_value(range->template get<2>()),
+                                  range.source_text);
+        }
+        case 3:
+        {
+            // Nonterminals spelled like byte literals are single bytes (see is_byte_literal)
+            auto const& nonterminal = prim.template get<3>();
+            if (parsely::detail::is_byte_literal(nonterminal.source_text))
+            {
+                unsigned char const value = byte_value(nonterminal);
+                return add_byte_range(value, value, nonterminal.source_text);
+            }
+            return add(expression{.kind = expression_kind::nonterminal, .text = std::string{nonterminal.source_text}},
+                       nonterminal.source_text);
+        }
+        case 4:
+        {
+            auto const& any_char = prim.template get<4>();
+            return add(expression{.kind    = expression_kind::inbuilt,
+                                  .inbuilt = find_inbuilt("."),
+                                  .utf8    = true},
+                       any_char.source_text);
+        }
+        case 5:
+        {
+            auto const& inbuilt = prim.template get<5>();
+            auto const  name    = inbuilt->template get<1>().source_text;
+            auto const  fn      = find_inbuilt(name);
+            if (!fn && !m_error)
+                m_error = grammar_error{.offset = offset_of(name), .message = "Unknown inbuilt " + std::string{name}};
+            return add(expression{.kind    = expression_kind::inbuilt,
+                                  .inbuilt = fn,
+                                  .utf8    = name != "eoi" && name != "string"},
+                       inbuilt.source_text);
+        }
+        default:
+            return load_operator_table(prim.template get<6>());
+        }
+    }
+
+    constexpr auto load_operator_table(auto const& node) -> std::size_t
+    {
+        std::vector<std::string> operators;
+        auto const               add_operator = [&](auto const& terminal) constexpr
+        {
+            auto const& literal = terminal->template get<1>();
+            if (literal.source_text.empty() && !m_error)
+                m_error = grammar_error{.offset = offset_of(terminal.source_text), .message = "Empty operator"};
+            operators.emplace_back(literal.source_text);
+        };
+        auto const add_level = [&](auto const& level) constexpr
+        {
+            add_operator(level->template get<2>());
+            for (auto const& m : level->template get<3>().node_repetitions)
+                add_operator(m.template get<1>());
+        };
+
+        auto const& table = *node;
+        add_level(table.template get<8>());
+        for (auto const& m : table.template get<9>().node_repetitions)
+            add_level(m.template get<3>());
+
+        std::size_t const first_operand = load_prim(table.template get<4>());
+        std::size_t const operand       = load_prim(table.template get<4>());
+        std::size_t const result        = add_operator_table(m_grammar, first_operand, operand, std::move(operators));
+        m_offsets.resize(m_grammar.expressions.size(), offset_of(node.source_text));
+        return result;
+    }
+
+    static constexpr auto byte_value(auto const& node) -> unsigned char
+    {
+        return parsely::detail::byte_literal_value(node.source_text);
+    }
+
+    // Adds a char class matching the bytes in [first, last]
+    constexpr auto add_byte_range(unsigned char const first, unsigned char const last,
+                                  std::string_view const source_text) -> std::size_t
+    {
+        expression result{.kind = expression_kind::char_class};
+        for (unsigned c = first; c <= last; ++c)
+            result.chars.insert(static_cast<unsigned char>(c));
+        return add(std::move(result), source_text);
+    }
+};
+} // namespace detail
+
+// Loads a grammar from a description in the same syntax that parsely::parser accepts
+//
+// Fails if the description is malformed, refers to unknown symbols, defines a production twice, or is left recursive.
+constexpr auto load_grammar(std::string_view const description) -> std::expected<grammar, grammar_error>
+{
+    return detail::grammar_loader(description).load().transform_error(
+        [description](grammar_error error)
+        {
+            error.location = source_index{description}.location(error.offset);
+            return error;
+        });
+}
+} // namespace parsely::runtime
+
+#endif // INCLUDE_PARSELY_RUNTIME_GRAMMAR_LOADER_HPP
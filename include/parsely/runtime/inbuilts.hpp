@@ -0,0 +1,50 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_RUNTIME_INBUILTS_HPP
+#define INCLUDE_PARSELY_RUNTIME_INBUILTS_HPP
+
+#include <parsely/runtime/grammar.hpp>
+#include <parsely/utility/grammar_ast.hpp>
+
+#include <array>
+#include <string_view>
+
+namespace parsely::runtime
+{
+namespace detail
+{
+struct named_inbuilt
+{
+    std::string_view name;
+    inbuilt_function function;
+};
+
+// The inbuilts available to runtime grammars, named as in grammar descriptions
+//
+// The matcher of any char expressions is named ".", which can't be referred to as an inbuilt.
+inline constexpr std::array inbuilt_table{
+    named_inbuilt{.name = "letter", .function = parsely::detail::inbuilt_letter.parse.match},
+    named_inbuilt{.name = "digit", .function = parsely::detail::inbuilt_decimal_digit.parse.match},
+    named_inbuilt{.name = "space", .function = parsely::detail::inbuilt_white_space.parse.match},
+    named_inbuilt{.name = "eoi", .function = parsely::detail::inbuilt_eoi.parse},
+    named_inbuilt{.name = "string", .function = parsely::match_quoted_string},
+    named_inbuilt{.name = ".", .function = parsely::detail::inbuilt_any.parse.match},
+};
+} // namespace detail
+
+// Returns the function matching the inbuilt named name, or nullptr if there is none
+constexpr auto find_inbuilt(std::string_view const name) -> inbuilt_function
+{
+    for (detail::named_inbuilt const& inbuilt : detail::inbuilt_table)
+    {
+        if (inbuilt.name == name)
+            return inbuilt.function;
+    }
+    return nullptr;
+}
+} // namespace parsely::runtime
+
+#endif // INCLUDE_PARSELY_RUNTIME_INBUILTS_HPP
@@ -0,0 +1,90 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_RUNTIME_RUNTIME_PARSER_HPP
+#define INCLUDE_PARSELY_RUNTIME_RUNTIME_PARSER_HPP
+
+#include <parsely/runtime/bytecode.hpp>
+#include <parsely/runtime/grammar.hpp>
+#include <parsely/runtime/grammar_loader.hpp>
+#include <parsely/runtime/vm.hpp>
+
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <string_view>
+
+namespace parsely::runtime
+{
+// A parser for a grammar that is only known at runtime
+//
+// The grammar is compiled into a program for the parsing virtual machine. Parse trees are dynamic_trees, whose nodes
+// refer to productions by index.
+class runtime_parser
+{
+  public:
+    // Creates a parser from a grammar description in the same syntax that parsely::parser accepts
+    static constexpr auto create(std::string_view const description) -> std::expected<runtime_parser, grammar_error>
+    {
+        return load_grammar(description).transform([](grammar const& g) { return runtime_parser(g); });
+    }
+
+    // Creates a parser for the given grammar, which must not be left recursive
+    constexpr explicit runtime_parser(grammar const& g)
+        : m_program(compile(g))
+    {
+    }
+
+    // Parses the given input string, starting with the production first mentioned in the grammar
+    [[nodiscard]] constexpr auto parse(std::string_view const input) const -> dynamic_tree
+    {
+        dynamic_tree tree;
+        vm().run(m_program, 0, input, tree);
+        return tree;
+    }
+
+    // Parses the given input string, starting with the production named symbol
+    //
+    // Returns an invalid tree if there is no such production.
+    [[nodiscard]] constexpr auto parse(std::string_view const symbol, std::string_view const input) const
+        -> dynamic_tree
+    {
+        dynamic_tree tree;
+        if (auto const production = find_production(symbol))
+            vm().run(m_program, *production, input, tree);
+        return tree;
+    }
+
+    // Parses the given input string into an existing tree, reusing its storage and that of the given machine
+    constexpr void parse_into(dynamic_tree& tree, vm& machine, std::string_view const input) const
+    {
+        machine.run(m_program, 0, input, tree);
+    }
+
+    // Returns the index of the production named symbol
+    [[nodiscard]] constexpr auto find_production(std::string_view const symbol) const -> std::optional<std::size_t>
+    {
+        for (std::size_t i = 0; i < m_program.symbols.size(); ++i)
+        {
+            if (m_program.symbols[i] == symbol)
+                return i;
+        }
+        return std::nullopt;
+    }
+
+    // Returns the symbol of the production that node was generated from
+    [[nodiscard]] constexpr auto symbol(dynamic_node const& node) const -> std::string_view
+    {
+        return m_program.symbols[node.production];
+    }
+
+    [[nodiscard]] constexpr auto program() const -> runtime::program const& { return m_program; }
+
+  private:
+    runtime::program m_program;
+};
+} // namespace parsely::runtime
+
+#endif // INCLUDE_PARSELY_RUNTIME_RUNTIME_PARSER_HPP
@@ -0,0 +1,210 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_RUNTIME_STATIC_PROGRAM_HPP
+#define INCLUDE_PARSELY_RUNTIME_STATIC_PROGRAM_HPP
+
+#include <parsely/runtime/bytecode.hpp>
+#include <parsely/runtime/grammar.hpp>
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
+
+#include <structural/tuple.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace parsely::runtime
+{
+namespace detail
+{
+// Converts the grammar of a compile-time parser into a runtime grammar
+//
+// Inbuilts matching single chars become char classes, all other inbuilts keep their matching function. Operator tables
+// become repetitions, which recognize the same inputs.
+template<typename Parser>
+class grammar_converter
+{
+  public:
+    constexpr auto convert() && -> grammar
+    {
+        [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        { (add_production(structural::get<is>(traits::grammar.productions)), ...); }(
+            std::make_index_sequence<traits::production_count>{});
+        return std::move(m_grammar);
+    }
+
+  private:
+    using traits = parsely::detail::grammar_traits<Parser>;
+
+    grammar m_grammar;
+
+    constexpr void add_production(auto const& p)
+    {
+        std::size_t const expr = add_expression(p.expression);
+        m_grammar.productions.push_back(production{
+            .symbol     = std::string{std::string_view{p.symbol}},
+            .expression = expr,
+        });
+    }
+
+    static constexpr void add_operators(auto const& level, std::vector<std::string>& operators)
+    {
+        [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        { (operators.push_back(std::string{std::string_view{structural::get<is>(level.operators).terminal}}), ...); }(
+            std::make_index_sequence<std::tuple_size_v<decltype(level.operators)>>{});
+    }
+
+    template<typename Expr>
+    constexpr auto add_expression(Expr const& expr) -> std::size_t
+    {
+        expression result;
+        auto const add_children = [&](auto const& tuple) constexpr
+        {
+            [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+            { (result.children.push_back(add_expression(structural::get<is>(tuple))), ...); }(
+                std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(tuple)>>>{});
+        };
+
+        if constexpr (requires { expr.symbol; })
+        {
+            result.kind       = expression_kind::nonterminal;
+            result.text       = std::string{std::string_view{expr.symbol}};
+            result.production = traits::index_of(expr.symbol);
+        }
+        else if constexpr (requires { expr.terminal; })
+        {
+            result.kind = expression_kind::terminal;
+            result.text = std::string{std::string_view{expr.terminal}};
+        }
+        else if constexpr (requires { expr.sequence; })
+        {
+            result.kind = expression_kind::seq;
+            add_children(expr.sequence);
+        }
+        else if constexpr (requires { expr.alternatives; })
+        {
+            result.kind = expression_kind::alt;
+            add_children(expr.alternatives);
+        }
+        else if constexpr (requires { expr.element; })
+        {
+            result.kind = expression_kind::rep;
+            result.children.push_back(add_expression(expr.element));
+        }
+        else if constexpr (requires { expr.operand; })
+        {
+            std::vector<std::string> operators;
+            [&]<std::size_t... ls>(std::index_sequence<ls...>) constexpr
+            { (add_operators(structural::get<ls>(expr.levels), operators), ...); }(
+                std::make_index_sequence<std::tuple_size_v<decltype(expr.levels)>>{});
+            std::size_t const first_operand = add_expression(expr.operand);
+            return add_operator_table(m_grammar, first_operand, add_expression(expr.operand), std::move(operators));
+        }
+        else if constexpr (std::is_invocable_r_v<bool, decltype(expr.parse), char>)
+        {
+            result.kind  = expression_kind::char_class;
+            result.chars = char_class::from_predicate(expr.parse);
+        }
+        else if constexpr (parsely::detail::is_codepoint_expr<Expr>)
+        {
+            result.kind    = expression_kind::inbuilt;
+            result.inbuilt = expr.parse.match;
+            result.utf8    = true;
+        }
+        else if constexpr (parsely::detail::is_quoted_string_expr<Expr>)
+        {
+            result.kind    = expression_kind::inbuilt;
+            result.inbuilt = &parsely::match_quoted_string;
+        }
+        else
+        {
+            result.kind    = expression_kind::inbuilt;
+            result.inbuilt = static_cast<inbuilt_function>(expr.parse);
+        }
+        return m_grammar.add(std::move(result));
+    }
+};
+
+template<typename T, std::size_t N>
+constexpr auto to_array(std::vector<T> const& values) -> std::array<T, N>
+{
+    std::array<T, N> result{};
+    for (std::size_t i = 0; i < N; ++i)
+        result[i] = values[i];
+    return result;
+}
+} // namespace detail
+
+// The grammar of a compile-time parser, compiled into a program for the parsing virtual machine
+//
+// Like the programs emitted by generate_source, the program is stored in arrays, so it can be run in constant
+// expressions and at runtime without being compiled again. Unless BuildsTrees is true, the grammar is optimized for
+// recognition, so the program can't build the same parse trees as parser does. Otherwise, the program emits one
+// dynamic_node per matched production, except for operator tables, which only emit the nodes of their operands.
+template<typename Parser, bool BuildsTrees = false>
+struct static_program
+{
+  private:
+    static constexpr auto compiled() -> program
+    {
+        grammar g = detail::grammar_converter<Parser>().convert();
+        if constexpr (!BuildsTrees)
+            optimize_for_recognition(g);
+        return compile(g);
+    }
+
+    // All strings, concatenated
+    static constexpr auto s_chars = []
+    {
+        constexpr std::size_t size = []
+        {
+            std::size_t n = 0;
+            for (std::string const& str : compiled().strings)
+                n += str.size();
+            return n;
+        }();
+
+        std::array<char, size> result{};
+        std::size_t            n = 0;
+        for (std::string const& str : compiled().strings)
+        {
+            for (char const c : str)
+                result[n++] = c;
+        }
+        return result;
+    }();
+
+  public:
+    static constexpr bool utf8 = compiled().utf8;
+
+    static constexpr auto code    = detail::to_array<instruction, compiled().code.size()>(compiled().code);
+    static constexpr auto sets    = detail::to_array<char_class, compiled().sets.size()>(compiled().sets);
+    static constexpr auto entries = detail::to_array<std::uint32_t, compiled().entries.size()>(compiled().entries);
+    static constexpr auto inbuilts =
+        detail::to_array<inbuilt_function, compiled().inbuilts.size()>(compiled().inbuilts);
+
+    static constexpr auto strings = []
+    {
+        program const                                           prog = compiled();
+        std::array<std::string_view, compiled().strings.size()> result{};
+        std::size_t                                             offset = 0;
+        for (std::size_t i = 0; i < result.size(); ++i)
+        {
+            result[i] = std::string_view{s_chars.data() + offset, prog.strings[i].size()};
+            offset += prog.strings[i].size();
+        }
+        return result;
+    }();
+};
+} // namespace parsely::runtime
+
+#endif // INCLUDE_PARSELY_RUNTIME_STATIC_PROGRAM_HPP
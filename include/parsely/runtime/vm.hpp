@@ -0,0 +1,318 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_RUNTIME_VM_HPP
+#define INCLUDE_PARSELY_RUNTIME_VM_HPP
+
+#include <parsely/runtime/bytecode.hpp>
+#include <parsely/utility/utf8.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace parsely::runtime
+{
+// A node of a dynamic parse tree. One node is emitted for each matched production.
+struct dynamic_node
+{
+    std::uint32_t production  = 0; // Index of the matched production
+    std::size_t   begin       = 0; // Offset of the first char of the matched input
+    std::size_t   end         = 0; // Offset one past the last char of the matched input
+    std::size_t   descendants = 0; // Number of nodes in the subtree rooted at this node, excluding itself
+
+    constexpr auto operator==(dynamic_node const&) const -> bool = default;
+};
+
+// A parse tree whose shape is only known at runtime
+//
+// Nodes are stored in post-order, so the root is the last node, and the descendants of the node at index i are stored
+// at indices [i - descendants, i).
+struct dynamic_tree
+{
+    bool                      valid = false; // True if parsing successful
+    std::string_view          source_text;   // Consumed source text if valid, otherwise the input up to the furthest
+                                             // position that parsing reached
+    std::vector<dynamic_node> nodes;         // All nodes in post-order
+
+    constexpr explicit operator bool() const { return valid; };
+
+    // Returns the index of the root node
+    [[nodiscard]] constexpr auto root() const -> std::size_t { return nodes.size() - 1; }
+
+    // Returns the indices of the children of the node at index i, in order
+    [[nodiscard]] constexpr auto children(std::size_t const i) const -> std::vector<std::size_t>
+    {
+        std::vector<std::size_t> result;
+        std::size_t const        first = i - nodes[i].descendants;
+        for (std::size_t child = i; child > first;)
+        {
+            --child;
+            result.push_back(child);
+            child -= nodes[child].descendants;
+        }
+        std::ranges::reverse(result);
+        return result;
+    }
+
+    // Returns the source text matched by the node at index i
+    [[nodiscard]] constexpr auto text(std::size_t const i) const -> std::string_view
+    {
+        return std::string_view{source_text.data() + nodes[i].begin, source_text.data() + nodes[i].end};
+    }
+};
+
+// The result of running the parsing virtual machine without building a parse tree
+struct recognition
+{
+    bool        valid  = false; // True if parsing successful
+    std::size_t length = 0;     // Consumed chars if valid, otherwise the furthest position that parsing reached
+
+    constexpr explicit operator bool() const { return valid; }
+};
+
+// The parsing virtual machine
+//
+// The machine keeps its stacks between runs, so reusing it avoids allocations. It doesn't recurse, and executes
+// instructions in bounded slices, so large inputs can be parsed in constant expressions without exceeding the
+// compiler's limits on recursion depth and loop iterations.
+class vm
+{
+  public:
+    // Runs prog on input, starting with the production at index production, and stores the result in tree
+    //
+    // Prog is a program, or any type with the same members, such as static_program.
+    template<typename Program>
+    constexpr void run(Program const&         prog,
+                       std::size_t const      production,
+                       std::string_view const input,
+                       dynamic_tree&          tree)
+    {
+        recognition const result = execute<true>(prog, production, input, tree.nodes);
+        tree.valid               = result.valid;
+        tree.source_text         = input.substr(0, result.length);
+    }
+
+    // Runs prog on input like run, but only determines whether and how far input matches
+    //
+    // No nodes are emitted, so the only memory used are the backtrack and call stacks, whose storage is reused.
+    template<typename Program>
+    constexpr auto recognize(Program const& prog, std::size_t const production, std::string_view const input)
+        -> recognition
+    {
+        std::vector<dynamic_node> no_nodes;
+        return execute<false>(prog, production, input, no_nodes);
+    }
+
+  private:
+    // Instructions executed per iteration of the outer loop of execute; GCC limits constant evaluation to 262144
+    // iterations per loop by default
+    static constexpr std::size_t s_slice_size = std::size_t{1} << 16;
+
+    template<bool EmitNodes, typename Program>
+    constexpr auto execute(Program const&             prog,
+                           std::size_t const          production,
+                           std::string_view const     input,
+                           std::vector<dynamic_node>& nodes) -> recognition
+    {
+        nodes.clear();
+
+        if (prog.utf8)
+        {
+            if (std::size_t const valid = valid_utf8_prefix(input); valid != input.size())
+                return recognition{.valid = false, .length = valid};
+        }
+
+        m_backtrack.clear();
+        m_calls.clear();
+        m_calls.push(call_frame{
+            .return_pc  = program::s_end_address,
+            .production = static_cast<std::uint32_t>(production),
+            .begin      = 0,
+            .nodes      = 0,
+        });
+
+        std::uint32_t pc       = prog.entries[production];
+        std::size_t   pos      = 0;
+        std::size_t   furthest = 0;
+
+        // Raw pointers avoid the bounds checks of the containers, which are costly in constant expressions
+        instruction const* const code  = prog.code.data();
+        char const* const        chars = input.data();
+
+        auto const next_in = [&](char_class const& set)
+        { return pos < input.size() && set.contains(static_cast<unsigned char>(chars[pos])); };
+
+        while (true)
+        {
+            for (std::size_t step = 0; step < s_slice_size; ++step)
+            {
+                instruction const& i  = code[pc];
+                bool               ok = true;
+                switch (i.op)
+                {
+                case opcode::end:
+                    return recognition{.valid = true, .length = pos};
+                case opcode::fail:
+                    ok = false;
+                    break;
+                case opcode::string:
+                {
+                    std::string_view const str = prog.strings[i.arg];
+                    ok                         = input.substr(pos).starts_with(str);
+                    if (ok)
+                        pos += str.size();
+                    ++pc;
+                    break;
+                }
+                case opcode::set:
+                    ok = next_in(prog.sets[i.arg]);
+                    if (ok)
+                        ++pos;
+                    ++pc;
+                    break;
+                case opcode::span:
+                {
+                    char_class const& set = prog.sets[i.arg];
+                    while (next_in(set))
+                        ++pos;
+                    ++pc;
+                    break;
+                }
+                case opcode::inbuilt:
+                {
+                    auto const length = prog.inbuilts[i.arg](input.substr(pos));
+                    ok                = length.has_value();
+                    if (ok)
+                        pos += *length;
+                    ++pc;
+                    break;
+                }
+                case opcode::test_set:
+                    pc = next_in(prog.sets[i.arg]) ? pc + 1 : i.target;
+                    break;
+                case opcode::jump:
+                    pc = i.target;
+                    break;
+                case opcode::choice:
+                    m_backtrack.push(backtrack_entry{
+                        .pc       = i.target,
+                        .position = pos,
+                        .calls    = m_calls.size(),
+                        .nodes    = nodes.size(),
+                    });
+                    ++pc;
+                    break;
+                case opcode::commit:
+                    m_backtrack.pop();
+                    pc = i.target;
+                    break;
+                case opcode::partial_commit:
+                {
+                    backtrack_entry& entry = m_backtrack.back();
+                    ok                     = pos != entry.position;
+                    entry.position         = pos;
+                    entry.nodes            = nodes.size();
+                    pc                     = i.target;
+                    break;
+                }
+                case opcode::call:
+                    m_calls.push(call_frame{
+                        .return_pc  = pc + 1,
+                        .production = i.arg,
+                        .begin      = pos,
+                        .nodes      = nodes.size(),
+                    });
+                    pc = i.target;
+                    break;
+                case opcode::ret:
+                {
+                    call_frame const frame = m_calls.back();
+                    m_calls.pop();
+                    if constexpr (EmitNodes)
+                    {
+                        nodes.push_back(dynamic_node{
+                            .production  = frame.production,
+                            .begin       = frame.begin,
+                            .end         = pos,
+                            .descendants = nodes.size() - frame.nodes,
+                        });
+                    }
+                    pc = frame.return_pc;
+                    break;
+                }
+                }
+
+                if (ok)
+                    continue;
+
+                // Backtrack
+                furthest = std::max(furthest, std::min(pos, input.size()));
+                if (m_backtrack.empty())
+                {
+                    nodes.clear();
+                    return recognition{.valid = false, .length = furthest};
+                }
+                backtrack_entry const& entry = m_backtrack.back();
+                pc                           = entry.pc;
+                pos                          = entry.position;
+                m_calls.truncate(entry.calls);
+                nodes.resize(entry.nodes);
+                m_backtrack.pop();
+            }
+        }
+    }
+
+    // A stack that keeps its storage when popped, so it only allocates when growing beyond its largest size
+    template<typename T>
+    class stack
+    {
+      public:
+        [[nodiscard]] constexpr auto size() const -> std::size_t { return m_size; }
+        [[nodiscard]] constexpr auto empty() const -> bool { return m_size == 0; }
+        [[nodiscard]] constexpr auto back() -> T& { return m_storage[m_size - 1]; }
+
+        constexpr void push(T const& value)
+        {
+            if (m_size == m_storage.size())
+                m_storage.resize(std::max(2 * m_size, s_initial_size));
+            m_storage[m_size++] = value;
+        }
+
+        constexpr void pop() { --m_size; }
+        constexpr void truncate(std::size_t const size) { m_size = size; }
+        constexpr void clear() { m_size = 0; }
+
+      private:
+        static constexpr std::size_t s_initial_size = 64;
+
+        std::vector<T> m_storage;
+        std::size_t    m_size = 0;
+    };
+
+    struct backtrack_entry
+    {
+        std::uint32_t pc;       // Address to continue at
+        std::size_t   position; // Input position to restore
+        std::size_t   calls;    // Call stack size to restore
+        std::size_t   nodes;    // Node count to restore
+    };
+
+    struct call_frame
+    {
+        std::uint32_t return_pc;
+        std::uint32_t production;
+        std::size_t   begin; // Input position at which the production started
+        std::size_t   nodes; // Node count when the production started
+    };
+
+    stack<backtrack_entry> m_backtrack;
+    stack<call_frame>      m_calls;
+};
+} // namespace parsely::runtime
+
+#endif // INCLUDE_PARSELY_RUNTIME_VM_HPP
@@ -0,0 +1,409 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_AST_MAPPER_HPP
+#define INCLUDE_PARSELY_UTILITY_AST_MAPPER_HPP
+
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
+#include <parsely/utility/operator_table.hpp>
+#include <parsely/utility/parser_creator.hpp>
+#include <parsely/utility/parser_policies.hpp>
+#include <parsely/utility/recognizer.hpp>
+#include <parsely/utility/semantic_action.hpp>
+#include <parsely/utility/text.hpp>
+#include <parsely/utility/utf8.hpp>
+
+#include <structural/inplace_string.hpp>
+#include <structural/tuple.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace parsely
+{
+namespace detail
+{
+// What mappers map productions without a semantic action into
+enum class unmapped_productions
+{
+    nodes, // ast_nodes holding the mapped value of their expression (see parser::map)
+    text,  // Their source text, so only their lengths are recorded (see parser::fold and action_log)
+};
+
+// Builds the value of input from the decisions recorded while recognizing it, without materializing parse tree nodes
+//
+// Input must be known to match Expr, and decisions must start with the decisions recorded while recognizing it, like
+// for builders. Actions is a std::tuple of references to semantic_actions, which are only invoked for productions that
+// are part of the parse, once each. Terminals map into their source text, sequences into tuples, alternatives into
+// variants, repetitions into vectors and operator tables into operator_trees. Nonterminals map into the value
+// produced by their semantic action, or as given by Unmapped if there is none. Input is matched as chars, but source
+// text is handed out as the text type of Parser.
+template<typename Parser, auto Expr, typename Actions, unmapped_productions Unmapped>
+struct mapper;
+} // namespace detail
+
+// Generic node of a mapped tree, used for the productions named Symbol if there is no action for them in Actions
+//
+// The nested value is the mapped value of the production's expression, i.e. text for terminals, tuples for sequences,
+// variants for alternatives, vectors for repetitions and the mapped values of nonterminals. It is stored like the
+// nested nodes of parse trees, so unmapped productions can be recursive.
+template<typename Parser, structural::inplace_string Symbol, typename Actions>
+struct ast_node
+{
+    using value_type  = typename detail::mapper<Parser,
+                                                detail::grammar_traits<Parser>::template expression<Symbol>,
+                                                Actions,
+                                                detail::unmapped_productions::nodes>::value_type;
+    using nested_type = detail::nested_storage_t<Parser, value_type>;
+
+    static constexpr std::string_view symbol = Symbol;
+
+    detail::text_t<Parser> source_text; // Consumed source text
+    nested_type            nested;      // Indirectly stored mapped value of the expression
+
+    constexpr auto operator==(ast_node const&) const -> bool = default;
+
+    constexpr auto operator*() const& -> decltype(auto) { return nested.operator*(); }
+    constexpr auto operator*() & -> decltype(auto) { return nested.operator*(); }
+
+    constexpr auto operator->() const -> decltype(auto) { return nested.operator->(); }
+    constexpr auto operator->() -> decltype(auto) { return nested.operator->(); }
+};
+
+namespace detail
+{
+// A value built by a mapper, together with the length of the input it was built from
+template<typename T>
+struct mapped
+{
+    T           value;
+    std::size_t length = 0;
+};
+
+template<typename Actions, std::size_t Index>
+struct action_value
+{
+    using type = typename std::remove_cvref_t<std::tuple_element_t<Index, Actions>>::value_type;
+};
+
+// Combines the mapped values of the elements of a sequence or of the alternatives of an alternation into a Result
+template<template<typename...> typename Result,
+         typename Parser,
+         auto Elements,
+         typename Actions,
+         unmapped_productions Unmapped,
+         typename Indices = std::make_index_sequence<std::tuple_size_v<decltype(Elements)>>>
+struct combined_value;
+
+template<template<typename...> typename Result,
+         typename Parser,
+         auto Elements,
+         typename Actions,
+         unmapped_productions Unmapped,
+         std::size_t... is>
+struct combined_value<Result, Parser, Elements, Actions, Unmapped, std::index_sequence<is...>>
+{
+    using type = Result<typename mapper<Parser, structural::get<is>(Elements), Actions, Unmapped>::value_type...>;
+};
+
+// The value of productions without a semantic action
+template<typename Parser, structural::inplace_string Symbol, typename Actions, unmapped_productions Unmapped>
+struct unmapped_value
+{
+    using type = ast_node<Parser, Symbol, Actions>;
+};
+
+template<typename Parser, structural::inplace_string Symbol, typename Actions>
+struct unmapped_value<Parser, Symbol, Actions, unmapped_productions::text>
+{
+    using type = text_t<Parser>;
+};
+
+template<typename Parser, nonterminal_expr Expr, typename Actions, unmapped_productions Unmapped>
+struct mapper<Parser, Expr, Actions, Unmapped>
+{
+    using traits = grammar_traits<Parser>;
+
+    static constexpr std::size_t action_index = find_action_index<Expr.symbol>(std::type_identity<Actions>{});
+    static constexpr bool        has_action   = action_index < std::tuple_size_v<Actions>;
+
+    using value_type = typename std::conditional_t<has_action,
+                                                   action_value<Actions, action_index>,
+                                                   unmapped_value<Parser, Expr.symbol, Actions, Unmapped>>::type;
+
+    static constexpr auto map(std::string_view const      input,
+                              std::span<std::size_t const>& decisions,
+                              Actions const&                actions) -> mapped<value_type>
+    {
+        static_assert(traits::template production_index<Expr.symbol> < traits::production_count, "Unknown symbol!");
+        // When mapping into text, productions with an action are recorded whether they are captured or not
+        static_assert(Unmapped == unmapped_productions::text
+                          || traits::captured[traits::template production_index<Expr.symbol>],
+                      "Capturing only some productions isn't supported by mapping!");
+
+        if constexpr (!has_action && Unmapped == unmapped_productions::text)
+        {
+            std::size_t const length = pop_decision(decisions);
+            return mapped<value_type>{.value = from_chars<text_t<Parser>>(input.substr(0, length)), .length = length};
+        }
+        else
+        {
+            using expression = mapper<Parser, traits::template expression<Expr.symbol>, Actions, Unmapped>;
+            auto nested      = expression::map(input, decisions, actions);
+            auto const text  = from_chars<text_t<Parser>>(input.substr(0, nested.length));
+            if constexpr (has_action)
+            {
+                return mapped<value_type>{
+                    .value  = invoke_action(std::get<action_index>(actions).fn, text, std::move(nested.value)),
+                    .length = nested.length,
+                };
+            }
+            else
+            {
+                mapped<value_type> result{.length = nested.length};
+                result.value.source_text = text;
+                result.value.nested      = std::move(nested.value);
+                return result;
+            }
+        }
+    }
+};
+
+template<typename Parser, terminal_expr Expr, typename Actions, unmapped_productions Unmapped>
+struct mapper<Parser, Expr, Actions, Unmapped>
+{
+    using value_type = text_t<Parser>;
+
+    static constexpr auto map(std::string_view const input,
+                              std::span<std::size_t const>& /*decisions*/,
+                              Actions const& /*actions*/) -> mapped<value_type>
+    {
+        return mapped<value_type>{
+            .value  = from_chars<text_t<Parser>>(input.substr(0, Expr.terminal.size())),
+            .length = Expr.terminal.size(),
+        };
+    }
+};
+
+template<typename Parser, seq_expr Expr, typename Actions, unmapped_productions Unmapped>
+struct mapper<Parser, Expr, Actions, Unmapped>
+{
+    static constexpr std::size_t size = std::tuple_size_v<decltype(Expr.sequence)>;
+
+    template<std::size_t I>
+    using element = mapper<Parser, structural::get<I>(Expr.sequence), Actions, Unmapped>;
+
+    using value_type = typename combined_value<std::tuple, Parser, Expr.sequence, Actions, Unmapped>::type;
+
+    static constexpr auto map(std::string_view const      input,
+                              std::span<std::size_t const>& decisions,
+                              Actions const&                actions) -> mapped<value_type>
+    {
+        return [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        {
+            std::size_t length = 0;
+            auto const  next   = [&]<std::size_t I>(std::integral_constant<std::size_t, I>) constexpr
+            {
+                auto part = element<I>::map(input.substr(length), decisions, actions);
+                length += part.length;
+                return std::move(part.value);
+            };
+            // Braced initialization evaluates the elements in order
+            value_type value{next(std::integral_constant<std::size_t, is>{})...};
+            return mapped<value_type>{.value = std::move(value), .length = length};
+        }(std::make_index_sequence<size>{});
+    }
+};
+
+template<typename Parser, alt_expr Expr, typename Actions, unmapped_productions Unmapped>
+struct mapper<Parser, Expr, Actions, Unmapped>
+{
+    static constexpr std::size_t size = std::tuple_size_v<decltype(Expr.alternatives)>;
+
+    template<std::size_t I>
+    using alternative = mapper<Parser, structural::get<I>(Expr.alternatives), Actions, Unmapped>;
+
+    using value_type = typename combined_value<std::variant, Parser, Expr.alternatives, Actions, Unmapped>::type;
+
+    static constexpr auto map(std::string_view const      input,
+                              std::span<std::size_t const>& decisions,
+                              Actions const&                actions) -> mapped<value_type>
+    {
+        std::size_t const chosen = pop_decision(decisions);
+        return [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        {
+            mapped<value_type> result;
+            ((chosen == is && [&]
+              {
+                  auto part = alternative<is>::map(input, decisions, actions);
+                  result.value.template emplace<is>(std::move(part.value));
+                  result.length = part.length;
+                  return true;
+              }())
+             || ...);
+            return result;
+        }(std::make_index_sequence<size>{});
+    }
+};
+
+template<typename Parser, rep_expr Expr, typename Actions, unmapped_productions Unmapped>
+struct mapper<Parser, Expr, Actions, Unmapped>
+{
+    using element    = mapper<Parser, Expr.element, Actions, Unmapped>;
+    using value_type = std::vector<typename element::value_type>;
+
+    static constexpr auto map(std::string_view const      input,
+                              std::span<std::size_t const>& decisions,
+                              Actions const&                actions) -> mapped<value_type>
+    {
+        std::size_t const  count = pop_decision(decisions);
+        mapped<value_type> result;
+        result.value.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto part = element::map(input.substr(result.length), decisions, actions);
+            result.length += part.length;
+            result.value.push_back(std::move(part.value));
+        }
+        return result;
+    }
+};
+
+template<typename Parser, operator_expr Expr, typename Actions, unmapped_productions Unmapped>
+struct mapper<Parser, Expr, Actions, Unmapped>
+{
+    using operand    = mapper<Parser, Expr.operand, Actions, Unmapped>;
+    using value_type = operator_tree<typename operand::value_type, text_t<Parser>>;
+
+    static constexpr auto map(std::string_view const      input,
+                              std::span<std::size_t const>& decisions,
+                              Actions const&                actions) -> mapped<value_type>
+    {
+        using table = operator_table<Expr>;
+
+        std::size_t const        count = pop_decision(decisions);
+        mapped<value_type>       result;
+        std::vector<std::size_t> ops;
+        std::vector<source_span> spans;
+        result.value.operands.reserve(count + 1);
+        ops.reserve(count);
+        spans.reserve(count + 1);
+        for (std::size_t i = 0; i <= count; ++i)
+        {
+            if (i != 0)
+            {
+                ops.push_back(pop_decision(decisions));
+                result.length += table::entries[ops.back()].symbol.size();
+            }
+            auto part = operand::map(input.substr(result.length), decisions, actions);
+            spans.push_back(source_span{.begin = result.length, .end = result.length + part.length});
+            result.length += part.length;
+            result.value.operands.push_back(std::move(part.value));
+        }
+        auto const op   = [&](std::size_t const i) { return ops[i]; };
+        auto const span = [&](std::size_t const i) { return spans[i]; };
+        build_operations<Expr>(ops.size(), op, span, input, result.value.operations);
+        return result;
+    }
+};
+
+template<typename Parser, inbuilt_expr Expr, typename Actions, unmapped_productions Unmapped>
+struct mapper<Parser, Expr, Actions, Unmapped>
+{
+    using value_type = text_t<Parser>;
+
+    static constexpr auto map(std::string_view const input,
+                              std::span<std::size_t const>& /*decisions*/,
+                              Actions const& /*actions*/) -> mapped<value_type>
+    {
+        std::size_t const length = recognize<Parser, Expr>(input).length;
+        return mapped<value_type>{.value = from_chars<text_t<Parser>>(input.substr(0, length)), .length = length};
+    }
+};
+
+// A decision log forwarding to Log, which only records the decisions of the productions with a semantic action in
+// Actions
+//
+// The decisions of all other productions are replaced by their lengths, which is all that mapping them into their
+// source text needs.
+template<typename Log, typename Actions>
+class action_log
+{
+  public:
+    template<structural::inplace_string Symbol>
+    static constexpr bool records = find_action_index<Symbol>(std::type_identity<Actions>{})
+                                  < std::tuple_size_v<Actions>;
+
+    constexpr explicit action_log(Log& log)
+        : m_log(log)
+    {
+    }
+
+    [[nodiscard]] constexpr auto mark() const -> std::size_t { return m_log.mark(); }
+    constexpr void               push(std::size_t const decision) { m_log.push(decision); }
+    constexpr void               set(std::size_t const at, std::size_t const decision) { m_log.set(at, decision); }
+    constexpr void               truncate(std::size_t const at) { m_log.truncate(at); }
+    constexpr void recover(std::size_t const at, std::string_view const skipped) { m_log.recover(at, skipped); }
+
+  private:
+    Log& m_log;
+};
+
+// Parses input and maps it into a value using actions, which is a std::tuple of references to semantic_actions
+//
+// Nothing is built if input doesn't match. See parser::map and parser::fold.
+template<typename Parser, auto Expr, unmapped_productions Unmapped, typename Actions>
+constexpr auto map_expression(std::string_view const input, Actions const& actions)
+    -> fold_result<typename mapper<Parser, Expr, Actions, Unmapped>::value_type, text_t<Parser>>
+{
+    using mapper_type = mapper<Parser, Expr, Actions, Unmapped>;
+    using result_type = fold_result<typename mapper_type::value_type, text_t<Parser>>;
+    static_assert(std::ranges::all_of(grammar_traits<Parser>::sync_points,
+                                      [](std::string_view const sync) { return sync.empty(); }),
+                  "Recovering from failures isn't supported by mapping!");
+
+    if constexpr (grammar_traits<Parser>::matches_codepoints)
+    {
+        if (std::size_t const valid = valid_utf8_prefix(input); valid != input.size())
+            return result_type{.source_text = from_chars<text_t<Parser>>(input.substr(0, valid))};
+    }
+
+    decision_log       log;
+    match_result const recognized = [&]
+    {
+        if constexpr (Unmapped == unmapped_productions::text)
+        {
+            action_log<decision_log, Actions> recording{log};
+            return recognizer<Parser, Expr>::match(input, recording);
+        }
+        else
+        {
+            return recognizer<Parser, Expr>::match(input, log);
+        }
+    }();
+    if (!recognized)
+        return result_type{.source_text = from_chars<text_t<Parser>>(input.substr(0, recognized.length))};
+
+    std::span<std::size_t const> decisions = log.decisions();
+
+    auto built = mapper_type::map(input, decisions, actions);
+    return result_type{
+        .valid       = true,
+        .source_text = from_chars<text_t<Parser>>(input.substr(0, built.length)),
+        .value       = std::move(built.value),
+    };
+}
+} // namespace detail
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_AST_MAPPER_HPP
@@ -0,0 +1,439 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_EVENT_EMITTER_HPP
+#define INCLUDE_PARSELY_UTILITY_EVENT_EMITTER_HPP
+
+#include <parsely/utility/grammar_analysis.hpp>
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
+#include <parsely/utility/operator_table.hpp>
+#include <parsely/utility/parser_policies.hpp>
+#include <parsely/utility/recognizer.hpp>
+#include <parsely/utility/text.hpp>
+#include <parsely/utility/utf8.hpp>
+
+#include <structural/tuple.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace parsely::detail
+{
+template<typename Sink>
+constexpr void emit_enter(Sink& sink, std::string_view const symbol)
+{
+    if constexpr (requires { sink.enter(symbol); })
+        sink.enter(symbol);
+}
+
+template<typename Sink, typename Text>
+constexpr void emit_leave(Sink& sink, std::string_view const symbol, Text const source_text)
+{
+    if constexpr (requires { sink.leave(symbol, source_text); })
+        sink.leave(symbol, source_text);
+    else if constexpr (requires { sink.leave(symbol); })
+        sink.leave(symbol);
+}
+
+template<typename Sink, typename Text>
+constexpr void emit_token(Sink& sink, Text const source_text)
+{
+    if constexpr (requires { sink.token(source_text); })
+        sink.token(source_text);
+}
+
+// Forwards events to a sink, holding them back while the attempt that produced them may still fail
+//
+// Each attempt that may fail and be backtracked is held (see hold) until it either fails, which discards its events, or
+// can no longer fail, which releases it. Events are buffered only while an attempt is held, and reported in order once
+// no attempt is held anymore.
+template<typename Parser, typename Sink>
+class event_buffer
+{
+  public:
+    constexpr explicit event_buffer(Sink& sink)
+        : m_sink(sink)
+    {
+    }
+
+    constexpr void enter(std::string_view const symbol) { add(event{.kind = event_kind::enter, .symbol = symbol}); }
+
+    constexpr void leave(std::string_view const symbol, std::string_view const source)
+    {
+        add(event{.kind = event_kind::leave, .symbol = symbol, .source = source});
+    }
+
+    constexpr void token(std::string_view const source) { add(event{.kind = event_kind::token, .source = source}); }
+
+    // Holds back the events of an attempt, returning the mark to discard them at if it fails
+    [[nodiscard]] constexpr auto hold() -> std::size_t
+    {
+        ++m_holds;
+        return m_events.size();
+    }
+
+    // Discards the events of a held attempt that failed
+    constexpr void discard(std::size_t const mark)
+    {
+        m_events.resize(mark);
+        --m_holds;
+    }
+
+    // Releases the given number of holds and resets it to 0, reporting the buffered events if no hold is left
+    constexpr void release(std::size_t& holds)
+    {
+        m_holds -= holds;
+        holds = 0;
+        if (m_holds != 0)
+            return;
+        for (event const& e : m_events)
+            report(e);
+        m_events.clear();
+    }
+
+  private:
+    enum class event_kind : std::uint8_t
+    {
+        enter,
+        leave,
+        token
+    };
+
+    struct event
+    {
+        event_kind       kind = event_kind::token;
+        std::string_view symbol;
+        std::string_view source;
+    };
+
+    constexpr void add(event const& e)
+    {
+        if (m_holds == 0)
+            report(e);
+        else
+            m_events.push_back(e);
+    }
+
+    constexpr void report(event const& e)
+    {
+        switch (e.kind)
+        {
+        case event_kind::enter:
+            emit_enter(m_sink, e.symbol);
+            break;
+        case event_kind::leave:
+            emit_leave(m_sink, e.symbol, from_chars<text_t<Parser>>(e.source));
+            break;
+        case event_kind::token:
+            emit_token(m_sink, from_chars<text_t<Parser>>(e.source));
+            break;
+        }
+    }
+
+    Sink&              m_sink;
+    std::vector<event> m_events;
+    std::size_t        m_holds = 0;
+};
+
+// Matches input against a grammar expression and reports its parse as events, without building a parse tree
+//
+// Input is matched only once. Holds is the number of holds (see event_buffer) of the enclosing attempts that end with
+// the expression, which it releases as soon as the rest of the match can no longer fail, and resets to 0. Catching
+// expressions hold their own attempts, so the events of backtracked attempts are never reported. Productions that
+// aren't captured (see capture) are recognized and reported without the events of their expression.
+template<typename Parser, auto Expr>
+struct emitter;
+
+// Matches an expression, first releasing the holds if the expression can't fail
+template<typename Parser, auto Expr, typename Events>
+constexpr auto emit_expression(std::string_view const input, Events& events, std::size_t& holds) -> match_result
+{
+    if constexpr (is_infallible<Parser, Expr>())
+        events.release(holds);
+    return emitter<Parser, Expr>::emit(input, events, holds);
+}
+
+template<typename Parser, nonterminal_expr Expr>
+struct emitter<Parser, Expr>
+{
+    template<typename Events>
+    static constexpr auto emit(std::string_view const input, Events& events, std::size_t& holds) -> match_result
+    {
+        using traits = grammar_traits<Parser>;
+        constexpr std::size_t index = traits::template production_index<Expr.symbol>;
+        static_assert(index < traits::production_count, "Unknown symbol!");
+        static_assert(traits::sync_points[index].empty(), "Recovering from failures isn't supported by events!");
+
+        events.enter(std::string_view{Expr.symbol});
+        match_result result;
+        if constexpr (traits::captured[index])
+            result = emit_expression<Parser, traits::template expression<Expr.symbol>>(input, events, holds);
+        else
+            result = recognize<Parser, Expr>(input);
+        if (result)
+            events.leave(std::string_view{Expr.symbol}, input.substr(0, result.length));
+        return result;
+    }
+};
+
+template<typename Parser, terminal_expr Expr>
+struct emitter<Parser, Expr>
+{
+    template<typename Events>
+    static constexpr auto emit(std::string_view const input, Events& events, std::size_t& /*holds*/) -> match_result
+    {
+        if (!input.starts_with(Expr.terminal))
+            return match_result{};
+        if constexpr (Expr.terminal.size() != 0)
+            events.token(input.substr(0, Expr.terminal.size()));
+        return match_result{.valid = true, .length = Expr.terminal.size()};
+    }
+};
+
+// Holds are released before the first element after which no element can fail, and passed to the last element
+template<typename Parser, seq_expr Expr>
+struct emitter<Parser, Expr>
+{
+    static constexpr std::size_t size = std::tuple_size_v<decltype(Expr.sequence)>;
+
+    // Whether the elements from each index on can't fail
+    static constexpr auto infallible_rest = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        std::array<bool, size> const infallible = {is_infallible<Parser, structural::get<is>(Expr.sequence)>()...};
+        std::array<bool, size + 1>   result{};
+        result[size] = true;
+        for (std::size_t i = size; i-- > 0;)
+            result[i] = infallible[i] && result[i + 1];
+        return result;
+    }(std::make_index_sequence<size>{});
+
+    template<typename Events>
+    static constexpr auto emit(std::string_view const input, Events& events, std::size_t& holds) -> match_result
+    {
+        std::size_t length = 0;
+        bool const  valid  = [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        {
+            return ([&]
+                    {
+                        if constexpr (infallible_rest[is])
+                            events.release(holds);
+                        std::size_t none = 0;
+                        auto const  r    = emitter<Parser, structural::get<is>(Expr.sequence)>::emit(
+                            input.substr(length),
+                            events,
+                            is + 1 == size ? holds : none);
+                        length += r.length;
+                        return r.valid;
+                    }()
+                    && ...);
+        }(std::make_index_sequence<size>{});
+        return match_result{.valid = valid, .length = length};
+    }
+};
+
+// Each tried alternative is held, together with the holds of the expression, unless it is a predicted alternative
+// without a fallback. Failures are like in the recognizer.
+template<typename Parser, alt_expr Expr>
+struct emitter<Parser, Expr>
+{
+    using prediction = detail::prediction<Parser, Expr>;
+
+    static constexpr std::size_t size = prediction::size;
+
+    // Matches the alternative with the given index, or fails if there is none
+    template<typename Events>
+    static constexpr auto emit_alternative(std::size_t const index,
+                                           std::string_view const input,
+                                           Events& events,
+                                           std::size_t& holds) -> match_result
+    {
+        match_result result;
+        [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        {
+            ((index == is
+              && (result = emit_expression<Parser, structural::get<is>(Expr.alternatives)>(input, events, holds), true))
+             || ...);
+        }(std::make_index_sequence<size>{});
+        return result;
+    }
+
+    // Matches the alternative with the given index, discarding its events if it fails
+    template<typename Events>
+    static constexpr auto attempt_alternative(std::size_t const index,
+                                              std::string_view const input,
+                                              Events& events,
+                                              std::size_t& holds) -> match_result
+    {
+        std::size_t const  mark   = events.hold();
+        std::size_t        held   = holds + 1;
+        match_result const result = emit_alternative(index, input, events, held);
+        if (result)
+        {
+            events.release(held);
+            holds = 0;
+        }
+        else
+        {
+            events.discard(mark);
+        }
+        return result;
+    }
+
+    template<typename Events>
+    static constexpr auto emit(std::string_view const input, Events& events, std::size_t& holds) -> match_result
+    {
+        std::size_t const lookahead = prediction::lookahead(input);
+
+        match_result result;
+        if constexpr (prediction::predictive)
+        {
+            std::size_t chosen = prediction::table[lookahead];
+            if (prediction::fallback[chosen] < size)
+            {
+                result = attempt_alternative(chosen, input, events, holds);
+                if (!result)
+                {
+                    chosen = prediction::fallback[chosen];
+                    result = emit_alternative(chosen, input, events, holds);
+                }
+            }
+            else
+            {
+                result = emit_alternative(chosen, input, events, holds);
+            }
+
+            if (!result && chosen + 1 < size) // The alternatives after the chosen one fail without consuming input
+                result.length = 0;
+        }
+        else
+        {
+            [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+            {
+                ([&]
+                 {
+                     if (!prediction::is_candidate(is, lookahead))
+                     {
+                         result = match_result{};
+                         return false;
+                     }
+                     result = attempt_alternative(is, input, events, holds);
+                     return result.valid;
+                 }()
+                 || ...);
+            }(std::make_index_sequence<size>{});
+        }
+        return result;
+    }
+};
+
+// Each element is held until it matched, since elements that match the empty string end the repetition
+template<typename Parser, rep_expr Expr>
+struct emitter<Parser, Expr>
+{
+    template<typename Events>
+    static constexpr auto emit(std::string_view const input, Events& events, std::size_t& /*holds*/) -> match_result
+    {
+        std::size_t length = 0;
+        while (true)
+        {
+            std::size_t const mark = events.hold();
+            std::size_t       none = 0;
+            auto const        r    = emit_expression<Parser, Expr.element>(input.substr(length), events, none);
+            if (!r || r.length == 0)
+            {
+                events.discard(mark);
+                break;
+            }
+            std::size_t held = 1;
+            events.release(held);
+            length += r.length;
+        }
+        return match_result{.valid = true, .length = length};
+    }
+};
+
+// Operands and operators are reported in input order. The operators are held together with the operand after them.
+template<typename Parser, operator_expr Expr>
+struct emitter<Parser, Expr>
+{
+    template<typename Events>
+    static constexpr auto emit(std::string_view const input, Events& events, std::size_t& holds) -> match_result
+    {
+        using table = operator_table<Expr>;
+
+        // Once the first operand matched, the expression can't fail
+        match_result result = emit_expression<Parser, Expr.operand>(input, events, holds);
+        if (!result)
+            return result;
+        events.release(holds);
+
+        while (true)
+        {
+            std::string_view const rest = input.substr(result.length);
+            std::size_t const      op   = table::match(rest);
+            if (op == table::size)
+                break;
+
+            std::size_t const mark      = events.hold();
+            std::size_t       held      = 1;
+            std::size_t const op_length = table::entries[op].symbol.size();
+            events.token(rest.substr(0, op_length));
+            auto const r = emit_expression<Parser, Expr.operand>(rest.substr(op_length), events, held);
+            if (!r)
+            {
+                events.discard(mark);
+                break;
+            }
+            events.release(held);
+            result.length += op_length + r.length;
+        }
+        return result;
+    }
+};
+
+template<typename Parser, inbuilt_expr Expr>
+struct emitter<Parser, Expr>
+{
+    template<typename Events>
+    static constexpr auto emit(std::string_view const input, Events& events, std::size_t& /*holds*/) -> match_result
+    {
+        match_result const result = recognize<Parser, Expr>(input);
+        if (result)
+            events.token(input.substr(0, result.length));
+        return result;
+    }
+};
+
+// Parses input and reports the parse to sink as events, without building a parse tree
+//
+// The whole match is held until it can no longer fail, so nothing is reported if input doesn't match. See
+// parser::parse_events.
+template<typename Parser, auto Expr, typename Sink>
+constexpr auto emit_events(std::string_view const input, Sink& sink) -> match_result
+{
+    if constexpr (grammar_traits<Parser>::matches_codepoints)
+    {
+        if (std::size_t const valid = valid_utf8_prefix(input); valid != input.size())
+            return match_result{.valid = false, .length = valid};
+    }
+
+    event_buffer<Parser, Sink> events{sink};
+    std::size_t const          mark   = events.hold();
+    std::size_t                holds  = 1;
+    match_result const         result = emit_expression<Parser, Expr>(input, events, holds);
+    if (result)
+        events.release(holds);
+    else
+        events.discard(mark);
+    return result;
+}
+} // namespace parsely::detail
+
+#endif // INCLUDE_PARSELY_UTILITY_EVENT_EMITTER_HPP
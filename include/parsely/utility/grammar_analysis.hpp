@@ -0,0 +1,399 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_GRAMMAR_ANALYSIS_HPP
+#define INCLUDE_PARSELY_UTILITY_GRAMMAR_ANALYSIS_HPP
+
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
+
+#include <structural/tuple.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace parsely::detail
+{
+// A set of chars, stored as a bitmap
+class char_set
+{
+  public:
+    constexpr void insert(unsigned char const c) { m_bits[c / 64] |= std::uint64_t{1} << (c % 64); }
+
+    [[nodiscard]] constexpr auto contains(unsigned char const c) const -> bool
+    {
+        return (m_bits[c / 64] & (std::uint64_t{1} << (c % 64))) != 0;
+    }
+
+    constexpr auto operator|=(char_set const& other) -> char_set&
+    {
+        for (std::size_t i = 0; i < m_bits.size(); ++i)
+            m_bits[i] |= other.m_bits[i];
+        return *this;
+    }
+
+    // Returns the set containing all chars
+    static constexpr auto all() -> char_set
+    {
+        char_set result;
+        result.m_bits.fill(~std::uint64_t{0});
+        return result;
+    }
+
+    constexpr auto operator==(char_set const&) const -> bool = default;
+
+  private:
+    std::array<std::uint64_t, 4> m_bits{};
+};
+
+// Properties of an expression that allow predicting whether it can match
+struct expression_info
+{
+    bool     nullable   = false; // True if the expression may match without consuming input (NULLABLE)
+    bool     infallible = false; // True if the expression matches every input
+    char_set first;              // Chars that a non-empty match may start with (FIRST)
+
+    constexpr auto operator==(expression_info const&) const -> bool = default;
+};
+
+// Adds the first chars of the operators of an operator table level to the FIRST set of info
+constexpr void analyze_operators(auto const& level, expression_info& info)
+{
+    [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        (info.first.insert(
+             static_cast<unsigned char>(std::string_view{structural::get<is>(level.operators).terminal}.front())),
+         ...);
+    }(std::make_index_sequence<std::tuple_size_v<decltype(level.operators)>>{});
+}
+
+// Computes nullability, infallibility and FIRST set of an expression
+//
+// Lookup is called with the symbol of each nonterminal and returns the info of its production. Inbuilts matching a
+// single char are called for every char. Codepoint matchers may start with any non-ASCII char, $string starts with a
+// quote, and all other inbuilts are assumed to be nullable and to start with any char. Inbuilts are never infallible.
+template<typename Lookup>
+constexpr auto analyze_expression(auto const& expr, Lookup const& lookup) -> expression_info
+{
+    using expr_type = std::remove_cvref_t<decltype(expr)>;
+
+    expression_info info;
+    if constexpr (requires { expr.symbol; })
+    {
+        info = lookup(expr.symbol);
+    }
+    else if constexpr (requires { expr.terminal; })
+    {
+        std::string_view const terminal = expr.terminal;
+        info.nullable                   = terminal.empty();
+        info.infallible                 = terminal.empty();
+        if (!terminal.empty())
+            info.first.insert(static_cast<unsigned char>(terminal.front()));
+    }
+    else if constexpr (requires { expr.sequence; })
+    {
+        info.nullable   = true;
+        info.infallible = true;
+        auto const add  = [&](auto const& element) constexpr
+        {
+            if (!info.nullable) // The element can't start a match, and the sequence may fail
+                return;
+            auto const element_info = analyze_expression(element, lookup);
+            info.first |= element_info.first;
+            info.nullable   = element_info.nullable;
+            info.infallible = info.infallible && element_info.infallible;
+        };
+        [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        { (add(structural::get<is>(expr.sequence)), ...); }(
+            std::make_index_sequence<std::tuple_size_v<decltype(expr.sequence)>>{});
+    }
+    else if constexpr (requires { expr.alternatives; })
+    {
+        auto const add = [&](auto const& alternative) constexpr
+        {
+            auto const alternative_info = analyze_expression(alternative, lookup);
+            info.first |= alternative_info.first;
+            info.nullable   = info.nullable || alternative_info.nullable;
+            info.infallible = info.infallible || alternative_info.infallible;
+        };
+        [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        { (add(structural::get<is>(expr.alternatives)), ...); }(
+            std::make_index_sequence<std::tuple_size_v<decltype(expr.alternatives)>>{});
+    }
+    else if constexpr (requires { expr.element; })
+    {
+        info.nullable   = true;
+        info.infallible = true;
+        info.first      = analyze_expression(expr.element, lookup).first;
+    }
+    else if constexpr (requires { expr.operand; })
+    {
+        // Operators are never empty, so they only start a match after an empty operand
+        info = analyze_expression(expr.operand, lookup);
+        if (info.nullable)
+        {
+            [&]<std::size_t... ls>(std::index_sequence<ls...>) constexpr
+            {
+                (analyze_operators(structural::get<ls>(expr.levels), info), ...);
+            }(std::make_index_sequence<std::tuple_size_v<decltype(expr.levels)>>{});
+        }
+    }
+    else if constexpr (std::is_invocable_r_v<bool, decltype(expr.parse), char>)
+    {
+        for (unsigned c = 0; c < 256; ++c)
+        {
+            if (expr.parse(static_cast<char>(c)))
+                info.first.insert(static_cast<unsigned char>(c));
+        }
+    }
+    else if constexpr (is_codepoint_expr<expr_type>)
+    {
+        for (unsigned c = 0; c < 256; ++c)
+        {
+            char const ch = static_cast<char>(c);
+            if (c >= 0x80 || expr.parse(std::string_view{&ch, 1}))
+                info.first.insert(static_cast<unsigned char>(c));
+        }
+    }
+    else if constexpr (is_quoted_string_expr<expr_type>)
+    {
+        info.first.insert(static_cast<unsigned char>('"'));
+    }
+    else
+    {
+        info.nullable = true;
+        info.first    = char_set::all();
+    }
+    return info;
+}
+
+// NULLABLE and FIRST sets of the productions of the grammar of Parser
+template<typename Parser>
+struct production_infos;
+
+// Returns the info of a nonterminal calling the production at index, whose expression has the given info
+//
+// Productions that recover from failures match any non-empty input.
+template<typename Parser>
+constexpr auto nonterminal_info(std::size_t const index, expression_info info) -> expression_info
+{
+    if (!grammar_traits<Parser>::sync_points[index].empty())
+        info.first = char_set::all();
+    return info;
+}
+
+// Predicts which alternatives of an alternative expression may match, based on the next char of the input
+//
+// An alternative is a candidate for a lookahead if it is nullable or the lookahead is in its FIRST set. All other
+// alternatives fail without consuming input, so skipping them doesn't change the result. Empty alternatives, which are
+// nullable and have an empty FIRST set, always match the empty string. The expression is predictive if no lookahead
+// has more than one candidate besides empty alternatives. Then, the first candidate is tried, and if it fails, the
+// next empty alternative (if any) is taken without trying anything else.
+template<typename Parser, alt_expr Expr>
+struct prediction
+{
+    static constexpr std::size_t size         = std::tuple_size_v<decltype(Expr.alternatives)>;
+    static constexpr std::size_t end_of_input = 256; // Lookahead of empty inputs
+
+    static_assert(size < 256, "Too many alternatives!");
+
+    static constexpr auto alternatives = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        // Only instantiated for alternatives that contain nonterminals
+        auto const lookup = [](auto const& symbol) constexpr
+        {
+            std::size_t const index = grammar_traits<Parser>::index_of(symbol);
+            return nonterminal_info<Parser>(index, production_infos<Parser>::value[index]);
+        };
+        return std::array<expression_info, size>{analyze_expression(structural::get<is>(Expr.alternatives), lookup)...};
+    }(std::make_index_sequence<size>{});
+
+    static constexpr auto lookahead(std::string_view const input) -> std::size_t
+    {
+        return input.empty() ? end_of_input : static_cast<unsigned char>(input.front());
+    }
+
+    static constexpr auto is_candidate(std::size_t const alternative, std::size_t const lookahead) -> bool
+    {
+        auto const& info = alternatives[alternative];
+        if (lookahead == end_of_input)
+            return info.nullable;
+        return info.nullable || info.first.contains(static_cast<unsigned char>(lookahead));
+    }
+
+    static constexpr auto is_empty(std::size_t const alternative) -> bool
+    {
+        return alternatives[alternative].nullable && alternatives[alternative].first == char_set{};
+    }
+
+    // Index of the first candidate for each lookahead, or size if there is none
+    static constexpr auto table = []
+    {
+        std::array<std::uint8_t, end_of_input + 1> result{};
+        for (std::size_t l = 0; l < result.size(); ++l)
+        {
+            std::size_t i = 0;
+            while (i < size && !is_candidate(i, l))
+                ++i;
+            result[l] = static_cast<std::uint8_t>(i);
+        }
+        return result;
+    }();
+
+    // Index of the first empty alternative after each alternative, or size if there is none
+    static constexpr auto fallback = []
+    {
+        std::array<std::uint8_t, size + 1> result{};
+        std::size_t                        next = size;
+        for (std::size_t i = size + 1; i-- > 0;)
+        {
+            result[i] = static_cast<std::uint8_t>(next);
+            if (i < size && is_empty(i))
+                next = i;
+        }
+        return result;
+    }();
+
+    static constexpr bool predictive = []
+    {
+        for (std::size_t l = 0; l <= end_of_input; ++l)
+        {
+            std::size_t candidates = 0;
+            for (std::size_t i = 0; i < size; ++i)
+                candidates += is_candidate(i, l) && !is_empty(i) ? 1 : 0;
+            if (candidates > 1)
+                return false;
+        }
+        return true;
+    }();
+};
+
+// Checks whether none of the alternative expressions in Expr backtracks
+//
+// Nonterminals aren't followed.
+template<typename Parser, auto Expr>
+consteval auto is_predictive() -> bool
+{
+    if constexpr (requires { Expr.alternatives; })
+    {
+        return prediction<Parser, Expr>::predictive && []<std::size_t... is>(std::index_sequence<is...>) constexpr
+        { return (is_predictive<Parser, structural::get<is>(Expr.alternatives)>() && ...); }(
+                   std::make_index_sequence<std::tuple_size_v<decltype(Expr.alternatives)>>{});
+    }
+    else if constexpr (requires { Expr.sequence; })
+    {
+        return []<std::size_t... is>(std::index_sequence<is...>) constexpr
+        { return (is_predictive<Parser, structural::get<is>(Expr.sequence)>() && ...); }(
+                   std::make_index_sequence<std::tuple_size_v<decltype(Expr.sequence)>>{});
+    }
+    else if constexpr (requires { Expr.element; })
+    {
+        return is_predictive<Parser, Expr.element>();
+    }
+    else if constexpr (requires { Expr.operand; })
+    {
+        return is_predictive<Parser, Expr.operand>();
+    }
+    else
+    {
+        return true;
+    }
+}
+
+// Checks whether Expr matches every input, so that matching it can't fail
+template<typename Parser, auto Expr>
+consteval auto is_infallible() -> bool
+{
+    auto const lookup = [](auto const& symbol) constexpr
+    {
+        std::size_t const index = grammar_traits<Parser>::index_of(symbol);
+        return nonterminal_info<Parser>(index, production_infos<Parser>::value[index]);
+    };
+    return analyze_expression(Expr, lookup).infallible;
+}
+
+// NULLABLE and FIRST sets of the productions of the grammar of Parser
+//
+// Kept apart from grammar_analysis, so predicting alternatives doesn't depend on the analysis of whole productions.
+template<typename Parser>
+struct production_infos
+{
+    using traits = grammar_traits<Parser>;
+
+    static constexpr auto value = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        std::array<expression_info, traits::production_count> infos{};
+        auto const lookup = [&](auto const& symbol) constexpr
+        {
+            std::size_t const index = traits::index_of(symbol);
+            return nonterminal_info<Parser>(index, infos[index]);
+        };
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            ([&] constexpr
+             {
+                 auto const next = analyze_expression(structural::get<is>(traits::grammar.productions).expression,
+                                                      lookup);
+                 if (next != infos[is])
+                 {
+                     infos[is] = next;
+                     changed   = true;
+                 }
+             }(),
+             ...);
+        }
+        return infos;
+    }(std::make_index_sequence<traits::production_count>{});
+};
+
+// NULLABLE and FIRST sets of the productions of the grammar of Parser, and which productions are predictive
+template<typename Parser>
+struct grammar_analysis
+{
+    using traits = grammar_traits<Parser>;
+
+    // Info of each production, computed as the least fixed point over the whole grammar
+    static constexpr auto productions = production_infos<Parser>::value;
+
+    // True for each production whose expression never backtracks
+    static constexpr auto predictive = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        return std::array<bool, traits::production_count>{
+            is_predictive<Parser, structural::get<is>(traits::grammar.productions).expression>()...};
+    }(std::make_index_sequence<traits::production_count>{});
+
+    // Symbols of the productions that backtrack
+    static constexpr auto backtracking_productions = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        std::array<std::string_view, std::ranges::count(predictive, false)> result{};
+        std::size_t                                                          i = 0;
+        ((predictive[is] ? void() : void(result[i++] = structural::get<is>(traits::grammar.productions).symbol)), ...);
+        return result;
+    }(std::make_index_sequence<traits::production_count>{});
+
+    // Describes which productions backtrack
+    static constexpr auto backtracking_message() -> std::string
+    {
+        std::string message = "Productions that need backtracking:";
+        for (std::string_view const symbol : backtracking_productions)
+        {
+            message += ' ';
+            message += symbol;
+        }
+        return message;
+    }
+};
+} // namespace parsely::detail
+
+#endif // INCLUDE_PARSELY_UTILITY_GRAMMAR_ANALYSIS_HPP
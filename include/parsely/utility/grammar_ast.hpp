@@ -7,6 +7,8 @@
 #define INCLUDE_PARSELY_UTILITY_GRAMMAR_AST_HPP
 
 #include <parsely/utility/string.hpp>
+#include <parsely/utility/structural_index.hpp>
+#include <parsely/utility/utf8.hpp>
 
 #include <structural/inplace_string.hpp>
 #include <structural/tuple.hpp>
@@ -121,6 +123,40 @@ consteval auto make_nonterminal_expr(char const (&symbol)[N])
     return nonterminal_expr{structural::inplace_string<N>{symbol}};
 }
 
+// A precedence level of an operator table AST node
+template<typename... Operators>
+struct operator_level
+{
+    bool                            right_associative = false;
+    structural::tuple<Operators...> operators; // Terminal expressions
+
+    constexpr auto operator==(operator_level const&) const -> bool = default;
+};
+
+template<typename... Operators>
+consteval auto make_operator_level(bool const right_associative, Operators... operators)
+{
+    return operator_level{right_associative, structural::tuple{operators...}};
+}
+
+// An operator table AST node
+//
+// Matches operands separated by binary operators. The levels are listed from the lowest to the highest precedence.
+template<typename Operand, typename... Levels>
+struct operator_expr
+{
+    Operand                      operand;
+    structural::tuple<Levels...> levels;
+
+    constexpr auto operator==(operator_expr const&) const -> bool = default;
+};
+
+template<typename Operand, typename... Levels>
+consteval auto make_operator_expr(Operand operand, Levels... levels)
+{
+    return operator_expr{operand, structural::tuple{levels...}};
+}
+
 // An inbuilt expression AST node
 template<std::size_t N, typename Fn>
 struct inbuilt_expr
@@ -142,6 +178,7 @@ inline constexpr auto inbuilt_space    = make_inbuilt_expr("space", is_space);
 inline constexpr auto inbuilt_digit    = make_inbuilt_expr("digit", is_digit);
 inline constexpr auto inbuilt_alpha    = make_inbuilt_expr("alpha", is_alpha);
 inline constexpr auto inbuilt_alnum    = make_inbuilt_expr("alnum", is_alnum);
+inline constexpr auto inbuilt_xdigit   = make_inbuilt_expr("xdigit", is_xdigit);
 inline constexpr auto inbuilt_nonquote = make_inbuilt_expr("nonquote", [](char const c) { return c != '"'; });
 inline constexpr auto inbuilt_eoi      = make_inbuilt_expr("eoi",
                                                       [](std::string_view const input) -> std::optional<std::size_t>
@@ -150,6 +187,112 @@ inline constexpr auto inbuilt_eoi      = make_inbuilt_expr("eoi",
                                                               return 0;
                                                           return std::nullopt;
                                                       });
+
+// Matches a single byte in the range [first, last]
+struct byte_range
+{
+    unsigned char first = 0;
+    unsigned char last  = 0;
+
+    constexpr auto operator()(char const c) const -> bool
+    {
+        auto const byte = static_cast<unsigned char>(c);
+        return byte >= first && byte <= last;
+    }
+
+    constexpr auto operator==(byte_range const&) const -> bool = default;
+};
+
+// Checks whether an identifier is spelled like a hexadecimal byte literal such as "0x1F"
+//
+// Identifiers are matched before byte literals, so that identifiers such as "0xface" aren't split into a byte literal
+// followed by junk. Identifiers spelled like byte literals are byte literals, though.
+constexpr auto is_byte_literal(std::string_view const identifier) -> bool
+{
+    return identifier.size() == 4 && identifier.starts_with("0x") && is_xdigit(identifier[2])
+        && is_xdigit(identifier[3]);
+}
+
+// Returns the value of a hexadecimal byte literal such as "0x1F"
+constexpr auto byte_literal_value(std::string_view const literal) -> unsigned char
+{
+    return static_cast<unsigned char>(hex_value(literal[2]) * 16 + hex_value(literal[3]));
+}
+
+// Matches a single codepoint of UTF-8 encoded input
+//
+// Grammars containing codepoint matchers only accept valid UTF-8 input.
+struct codepoint_matcher
+{
+    auto (*match)(std::string_view) -> std::optional<std::size_t>;
+
+    constexpr auto operator()(std::string_view const input) const -> std::optional<std::size_t> { return match(input); }
+
+    constexpr auto operator==(codepoint_matcher const&) const -> bool = default;
+};
+
+inline constexpr auto inbuilt_any    = make_inbuilt_expr("any", codepoint_matcher{&match_codepoint<is_codepoint>});
+inline constexpr auto inbuilt_letter = make_inbuilt_expr("letter", codepoint_matcher{&match_codepoint<is_letter>});
+inline constexpr auto inbuilt_decimal_digit = make_inbuilt_expr("decimal_digit",
+                                                                codepoint_matcher{&match_codepoint<is_decimal_digit>});
+inline constexpr auto inbuilt_white_space   = make_inbuilt_expr("white_space",
+                                                              codepoint_matcher{&match_codepoint<is_white_space>});
+
+// Checks whether an expression matches codepoints rather than chars
+template<typename Expr>
+inline constexpr bool is_codepoint_expr = false;
+
+template<std::size_t N>
+inline constexpr bool is_codepoint_expr<inbuilt_expr<N, codepoint_matcher>> = true;
+
+// Matches a string delimited by quotes (see match_quoted_string)
+//
+// Parsers with the structural_scan policy look up the end of the string instead of scanning it.
+struct quoted_string_matcher
+{
+    constexpr auto operator()(std::string_view const input) const -> std::optional<std::size_t>
+    {
+        return match_quoted_string(input);
+    }
+
+    constexpr auto operator==(quoted_string_matcher const&) const -> bool = default;
+};
+
+inline constexpr auto inbuilt_string = make_inbuilt_expr("string", quoted_string_matcher{});
+
+// Checks whether an expression is $string
+template<typename Expr>
+inline constexpr bool is_quoted_string_expr = false;
+
+template<std::size_t N>
+inline constexpr bool is_quoted_string_expr<inbuilt_expr<N, quoted_string_matcher>> = true;
+
+// Checks whether Pred returns true for expr or any of its sub-expressions
+//
+// Nonterminals aren't followed.
+template<typename Pred>
+consteval auto any_subexpression(auto const& expr, Pred pred) -> bool
+{
+    if (pred(expr))
+        return true;
+
+    auto const any_of_tuple = [&](auto const& tuple)
+    {
+        return [&]<std::size_t... is>(std::index_sequence<is...>)
+        { return (any_subexpression(structural::get<is>(tuple), pred) || ...); }(
+                   std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(tuple)>>>{});
+    };
+    if constexpr (requires { expr.sequence; })
+        return any_of_tuple(expr.sequence);
+    else if constexpr (requires { expr.alternatives; })
+        return any_of_tuple(expr.alternatives);
+    else if constexpr (requires { expr.element; })
+        return any_subexpression(expr.element, pred);
+    else if constexpr (requires { expr.operand; })
+        return any_subexpression(expr.operand, pred);
+    else
+        return false;
+}
 } // namespace parsely::detail
 
 #endif // INCLUDE_PARSELY_UTILITY_GRAMMAR_AST_HPP
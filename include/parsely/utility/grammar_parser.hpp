@@ -13,6 +13,8 @@
 #include <structural/structuralize.hpp>
 #include <structural/tuple.hpp>
 
+#include <string>
+
 namespace parsely::detail
 {
 template<structural::inplace_string GrammarDescription>
@@ -25,10 +27,17 @@ struct grammar_parser
     // expression  : alt_expr
     // alt_expr    : seq_expr (_ "|" _ seq_expr)*
     // seq_expr    : prim_expr (__ prim_expr)*
-    // prim_expr   : paren_expr | terminal | nonterminal
+    // prim_expr   : paren_expr | terminal | byte_range | nonterminal | any_char | inbuilt | operator_table
     // paren_expr  : "(" _ expression _ ")"
     // terminal    : "\"" .* "\""
+    // byte_range  : byte ".." byte
+    // byte        : "0x" xdigit xdigit
     // nonterminal : (alnum | "_")+
+    // any_char    : "."
+    // inbuilt     : "$" nonterminal
+    // operator_table : "%operators" _ "(" _ prim_expr _ "," _ operator_level (_ "," _ operator_level)* _ ")"
+    // operator_level : associativity __ terminal (__ terminal)*
+    // associativity  : "left" | "right"
     // __          : space+
     // _           : __?
     static constexpr auto s_grammar = make_grammar(
@@ -72,12 +81,18 @@ struct grammar_parser
                                 make_seq_expr( //
                                     make_nonterminal_expr("__"),
                                     make_nonterminal_expr("prim_expr"))))),
-        // prim_expr: terminal | nonterminal ;
+        // prim_expr: paren_expr | terminal | byte_range | nonterminal | any_char | inbuilt | operator_table ;
+        // Single bytes are matched as nonterminals, so identifiers that start like them aren't split (see
+        // is_byte_literal)
         make_production("prim_expr",
                         make_alt_expr( //
                             make_nonterminal_expr("paren_expr"),
                             make_nonterminal_expr("terminal"),
-                            make_nonterminal_expr("nonterminal"))),
+                            make_nonterminal_expr("byte_range"),
+                            make_nonterminal_expr("nonterminal"),
+                            make_nonterminal_expr("any_char"),
+                            make_nonterminal_expr("inbuilt"),
+                            make_nonterminal_expr("operator_table"))),
         // paren_expr  : "(" _ expression _ ")" ;
         make_production("paren_expr",
                         make_seq_expr( //
@@ -92,11 +107,65 @@ struct grammar_parser
                             make_terminal_expr("\""))),
         // literal: $not_quote* ;
         make_production("literal", make_rep_expr(inbuilt_nonquote)),
+        // byte_range: byte ".." byte ;
+        make_production("byte_range",
+                        make_seq_expr( //
+                            make_nonterminal_expr("byte"),
+                            make_terminal_expr(".."),
+                            make_nonterminal_expr("byte"))),
+        // byte: "0x" $xdigit $xdigit ;
+        make_production("byte",
+                        make_seq_expr( //
+                            make_terminal_expr("0x"),
+                            inbuilt_xdigit,
+                            inbuilt_xdigit)),
         // nonterminal: id_char id_char* ;
         make_production("nonterminal",
                         make_seq_expr( //
                             make_nonterminal_expr("id_char"),
                             make_rep_expr(make_nonterminal_expr("id_char")))),
+        // any_char: "." ;
+        make_production("any_char", make_terminal_expr(".")),
+        // inbuilt: "$" nonterminal ;
+        make_production("inbuilt",
+                        make_seq_expr( //
+                            make_terminal_expr("$"),
+                            make_nonterminal_expr("nonterminal"))),
+        // operator_table: "%operators" _ "(" _ prim_expr _ "," _ operator_level ( _ "," _ operator_level )* _ ")" ;
+        make_production("operator_table",
+                        make_seq_expr( //
+                            make_terminal_expr("%operators"),
+                            make_nonterminal_expr("_"),
+                            make_terminal_expr("("),
+                            make_nonterminal_expr("_"),
+                            make_nonterminal_expr("prim_expr"),
+                            make_nonterminal_expr("_"),
+                            make_terminal_expr(","),
+                            make_nonterminal_expr("_"),
+                            make_nonterminal_expr("operator_level"),
+                            make_rep_expr(     //
+                                make_seq_expr( //
+                                    make_nonterminal_expr("_"),
+                                    make_terminal_expr(","),
+                                    make_nonterminal_expr("_"),
+                                    make_nonterminal_expr("operator_level"))),
+                            make_nonterminal_expr("_"),
+                            make_terminal_expr(")"))),
+        // operator_level: associativity __ terminal ( __ terminal )* ;
+        make_production("operator_level",
+                        make_seq_expr( //
+                            make_nonterminal_expr("associativity"),
+                            make_nonterminal_expr("__"),
+                            make_nonterminal_expr("terminal"),
+                            make_rep_expr(     //
+                                make_seq_expr( //
+                                    make_nonterminal_expr("__"),
+                                    make_nonterminal_expr("terminal"))))),
+        // associativity: "left" | "right" ;
+        make_production("associativity",
+                        make_alt_expr( //
+                            make_terminal_expr("left"),
+                            make_terminal_expr("right"))),
         // id_char: $alnum | "_" ;
         make_production("id_char",
                         make_alt_expr( //
@@ -128,6 +197,13 @@ struct grammar_parser
         return detail::parse_nonterminal<grammar_parser, nonterminal_expr{Symbol}>(input);
     }
 };
+
+template<structural::inplace_string Grammar>
+constexpr auto create_failure_string(auto /*parse_tree*/) -> std::string
+{
+    // TODO: Implement dynamic error string creation
+    return "The grammar is invalid.";
+}
 } // namespace parsely::detail
 
 namespace structural
@@ -236,7 +312,13 @@ STRUCTURAL_MAKE_NODE(seq_expr)
 STRUCTURAL_MAKE_NODE(prim_expr)
 STRUCTURAL_MAKE_NODE(paren_expr)
 STRUCTURAL_MAKE_NODE(terminal)
+STRUCTURAL_MAKE_NODE(byte_range)
+STRUCTURAL_MAKE_NODE(byte)
 STRUCTURAL_MAKE_NODE(nonterminal)
+STRUCTURAL_MAKE_NODE(any_char)
+STRUCTURAL_MAKE_NODE(inbuilt)
+STRUCTURAL_MAKE_NODE(operator_table)
+STRUCTURAL_MAKE_NODE(operator_level)
 
 #undef STRUCTURAL_MAKE_NODE
 
@@ -245,17 +327,25 @@ STRUCTURAL_MAKE_NODE(nonterminal)
 template<inplace_string GrammarDescription, wrapper WrappedValue>
 struct structuralizer<grammar_parse_tree_node_grammar<GrammarDescription>, WrappedValue>
 {
+    // The validity of the description is checked on the serialized parse tree, so the description is only parsed once
     static consteval auto do_structuralize()
     {
-        constexpr auto               first_production     = STRUCTURALIZE(WrappedValue.unwrap()->template get<1>());
-        static constexpr std::size_t num_more_productions = WrappedValue.unwrap()->template get<2>().size();
-        return []<std::size_t... Is>(std::index_sequence<Is...>)
+        if constexpr (!WrappedValue.unwrap().valid)
+        {
+            static_assert(false, parsely::detail::create_failure_string<GrammarDescription>(WrappedValue.unwrap()));
+        }
+        else
         {
-            return parsely::detail::make_grammar(first_production,
-                                                 STRUCTURALIZE(WrappedValue.unwrap()
-                                                                   ->template get<2>()[Is]
-                                                                   .template get<1>())...);
-        }(std::make_index_sequence<num_more_productions>{});
+            constexpr auto               first_production     = STRUCTURALIZE(WrappedValue.unwrap()->template get<1>());
+            static constexpr std::size_t num_more_productions = WrappedValue.unwrap()->template get<2>().size();
+            return []<std::size_t... Is>(std::index_sequence<Is...>)
+            {
+                return parsely::detail::make_grammar(first_production,
+                                                     STRUCTURALIZE(WrappedValue.unwrap()
+                                                                       ->template get<2>()[Is]
+                                                                       .template get<1>())...);
+            }(std::make_index_sequence<num_more_productions>{});
+        }
     }
 };
 
@@ -327,8 +417,18 @@ struct structuralizer<grammar_parse_tree_node_prim_expr<GrammarDescription>, Wra
             return STRUCTURALIZE(WrappedValue.unwrap()->template get<0>());
         else if constexpr (WrappedValue.unwrap()->index() == 1)
             return STRUCTURALIZE(WrappedValue.unwrap()->template get<1>());
-        else
+        else if constexpr (WrappedValue.unwrap()->index() == 2)
             return STRUCTURALIZE(WrappedValue.unwrap()->template get<2>());
+        else if constexpr (WrappedValue.unwrap()->index() == 3)
+            return STRUCTURALIZE(WrappedValue.unwrap()->template get<3>());
+        else if constexpr (WrappedValue.unwrap()->index() == 4)
+            return STRUCTURALIZE(WrappedValue.unwrap()->template get<4>());
+        else if constexpr (WrappedValue.unwrap()->index() == 5)
+            return STRUCTURALIZE(WrappedValue.unwrap()->template get<5>());
+        else if constexpr (WrappedValue.unwrap()->index() == 6)
+            return STRUCTURALIZE(WrappedValue.unwrap()->template get<6>());
+        else
+            return STRUCTURALIZE(WrappedValue.unwrap()->template get<7>());
     }
 };
 
@@ -348,13 +448,105 @@ struct structuralizer<grammar_parse_tree_node_terminal<GrammarDescription>, Wrap
     }
 };
 
+template<inplace_string GrammarDescription, wrapper WrappedValue>
+struct structuralizer<grammar_parse_tree_node_byte_range<GrammarDescription>, WrappedValue>
+{
+    static consteval auto do_structuralize()
+    {
+        static constexpr std::string_view first = WrappedValue.unwrap()->template get<0>().source_text;
+        static constexpr std::string_view last  = WrappedValue.unwrap()->template get<2>().source_text;
+        return parsely::detail::make_inbuilt_expr("byte_range",
+                                                  parsely::detail::byte_range{
+                                                      .first = parsely::detail::byte_literal_value(first),
+                                                      .last  = parsely::detail::byte_literal_value(last),
+                                                  });
+    }
+};
+
+// Nonterminals spelled like byte literals are single bytes, which are matched as one-element byte ranges
 template<inplace_string GrammarDescription, wrapper WrappedValue>
 struct structuralizer<grammar_parse_tree_node_nonterminal<GrammarDescription>, WrappedValue>
 {
     static consteval auto do_structuralize()
     {
         static constexpr auto symbol = WrappedValue.unwrap().source_text;
-        return parsely::detail::nonterminal_expr{structural::inplace_string<symbol.size()>{symbol}};
+        if constexpr (parsely::detail::is_byte_literal(symbol))
+        {
+            static constexpr unsigned char value = parsely::detail::byte_literal_value(symbol);
+            return parsely::detail::make_inbuilt_expr("byte",
+                                                      parsely::detail::byte_range{.first = value, .last = value});
+        }
+        else
+        {
+            return parsely::detail::nonterminal_expr{structural::inplace_string<symbol.size()>{symbol}};
+        }
+    }
+};
+
+template<inplace_string GrammarDescription, wrapper WrappedValue>
+struct structuralizer<grammar_parse_tree_node_any_char<GrammarDescription>, WrappedValue>
+{
+    static consteval auto do_structuralize() { return parsely::detail::inbuilt_any; }
+};
+
+template<inplace_string GrammarDescription, wrapper WrappedValue>
+struct structuralizer<grammar_parse_tree_node_inbuilt<GrammarDescription>, WrappedValue>
+{
+    static consteval auto do_structuralize()
+    {
+        static constexpr std::string_view name = WrappedValue.unwrap()->template get<1>().source_text;
+        if constexpr (name == "letter")
+            return parsely::detail::inbuilt_letter;
+        else if constexpr (name == "digit")
+            return parsely::detail::inbuilt_decimal_digit;
+        else if constexpr (name == "space")
+            return parsely::detail::inbuilt_white_space;
+        else if constexpr (name == "eoi")
+            return parsely::detail::inbuilt_eoi;
+        else if constexpr (name == "string")
+            return parsely::detail::inbuilt_string;
+        else
+            static_assert(false, "Unknown inbuilt!");
+    }
+};
+
+template<inplace_string GrammarDescription, wrapper WrappedValue>
+struct structuralizer<grammar_parse_tree_node_operator_table<GrammarDescription>, WrappedValue>
+{
+    static consteval auto do_structuralize()
+    {
+        static constexpr auto operand         = STRUCTURALIZE(WrappedValue.unwrap()->template get<4>());
+        static constexpr auto first_level     = STRUCTURALIZE(WrappedValue.unwrap()->template get<8>());
+        static constexpr auto more_level_size = WrappedValue.unwrap()->template get<9>().size();
+
+        return []<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            return parsely::detail::make_operator_expr(operand,
+                                                       first_level,
+                                                       STRUCTURALIZE(WrappedValue.unwrap()
+                                                                         ->template get<9>()[Is]
+                                                                         .template get<3>())...);
+        }(std::make_index_sequence<more_level_size>{});
+    }
+};
+
+template<inplace_string GrammarDescription, wrapper WrappedValue>
+struct structuralizer<grammar_parse_tree_node_operator_level<GrammarDescription>, WrappedValue>
+{
+    static consteval auto do_structuralize()
+    {
+        static constexpr bool right_associative  = WrappedValue.unwrap()->template get<0>()->index() == 1;
+        static constexpr auto first_operator     = STRUCTURALIZE(WrappedValue.unwrap()->template get<2>());
+        static constexpr auto more_operator_size = WrappedValue.unwrap()->template get<3>().size();
+
+        return []<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            return parsely::detail::make_operator_level(right_associative,
+                                                        first_operator,
+                                                        STRUCTURALIZE(WrappedValue.unwrap()
+                                                                          ->template get<3>()[Is]
+                                                                          .template get<1>())...);
+        }(std::make_index_sequence<more_operator_size>{});
     }
 };
 } // namespace structural
@@ -0,0 +1,141 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_GRAMMAR_TRAITS_HPP
+#define INCLUDE_PARSELY_UTILITY_GRAMMAR_TRAITS_HPP
+
+#include <parsely/utility/grammar_ast.hpp>
+
+#include <structural/inplace_string.hpp>
+#include <structural/tuple.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+namespace parsely::detail
+{
+// Compile-time information about the grammar of a parser
+template<typename Parser>
+struct grammar_traits
+{
+    static constexpr auto        grammar          = Parser::s_grammar;
+    static constexpr std::size_t production_count = grammar.production_count();
+
+    // Symbol of each production, in the order they are listed
+    static constexpr auto symbols = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        return std::array<std::string_view, production_count>{
+            std::string_view{structural::get<is>(grammar.productions).symbol}...};
+    }(std::make_index_sequence<production_count>{});
+
+    // Index of the production named symbol, or production_count if there is none
+    //
+    // Symbols are looked up in a flat array, so resolving a symbol doesn't instantiate anything per production.
+    static constexpr auto index_of(std::string_view const symbol) -> std::size_t
+    {
+        return static_cast<std::size_t>(std::ranges::find(symbols, symbol) - symbols.begin());
+    }
+
+    // Index of the production named Symbol, or production_count if there is none
+    //
+    // This is the integer id of the production. It is resolved once per symbol, and all other lookups of the production
+    // go through it.
+    template<structural::inplace_string Symbol>
+    static constexpr std::size_t production_index = index_of(Symbol);
+
+    // Expression of the production named Symbol
+    template<structural::inplace_string Symbol>
+    static constexpr auto expression = structural::get<production_index<Symbol>>(grammar.productions).expression;
+
+    // True if the grammar contains expressions that match codepoints, in which case inputs must be valid UTF-8
+    static constexpr bool matches_codepoints = []<std::size_t... is>(std::index_sequence<is...>) consteval
+    {
+        constexpr auto is_codepoint = []<typename Expr>(Expr const&) { return is_codepoint_expr<Expr>; };
+        return (any_subexpression(structural::get<is>(grammar.productions).expression, is_codepoint) || ...);
+    }(std::make_index_sequence<production_count>{});
+
+    // True if the quotes of inputs are indexed before parsing them (see structural_scan)
+    static constexpr bool scans_structure = []
+    {
+        if constexpr (requires { Parser::scans_structure; })
+            return Parser::scans_structure;
+        else
+            return false;
+    }();
+
+    // True if nonterminal parse tree nodes store the hash of their subtree (see hashed_tree)
+    static constexpr bool hashes_subtrees = []
+    {
+        if constexpr (requires { Parser::hashes_subtrees; })
+            return Parser::hashes_subtrees;
+        else
+            return false;
+    }();
+
+    // The text at which failures of each production are recovered from (see recover), or an empty string if they aren't
+    static constexpr auto sync_points = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        std::array<std::string_view, production_count> result{};
+        if constexpr (requires { Parser::sync_point(std::string_view{}); })
+        {
+            ((result[is] = Parser::sync_point(std::string_view{structural::get<is>(grammar.productions).symbol})),
+             ...);
+        }
+        return result;
+    }(std::make_index_sequence<production_count>{});
+
+    // True for each production whose nodes are built (see capture)
+    //
+    // Unless the parser captures only some productions, these are all productions. Otherwise, they are the captured
+    // productions, those that recover from failures, and those that lead to either of them.
+    static constexpr auto captured = []<std::size_t... is>(std::index_sequence<is...>) consteval
+    {
+        std::array<bool, production_count> result{};
+        result.fill(true);
+        if constexpr (requires { Parser::captures(std::string_view{}); })
+        {
+            // refers[i][j] is true if production i refers to production j
+            std::array<std::array<bool, production_count>, production_count> refers{};
+            auto const record = [&](std::size_t const i, auto const& expr)
+            {
+                any_subexpression(expr,
+                                  [&]<typename Expr>(Expr const& sub)
+                                  {
+                                      if constexpr (requires { sub.symbol; })
+                                      {
+                                          if (std::size_t const j = index_of(sub.symbol); j < production_count)
+                                              refers[i][j] = true;
+                                      }
+                                      return false;
+                                  });
+            };
+            (record(is, structural::get<is>(grammar.productions).expression), ...);
+            ((result[is] = Parser::captures(symbols[is]) || !sync_points[is].empty()), ...);
+
+            for (bool changed = true; changed;)
+            {
+                changed = false;
+                for (std::size_t i = 0; i < production_count; ++i)
+                {
+                    for (std::size_t j = 0; j < production_count && !result[i]; ++j)
+                    {
+                        if (refers[i][j] && result[j])
+                        {
+                            result[i] = true;
+                            changed   = true;
+                        }
+                    }
+                }
+            }
+        }
+        return result;
+    }(std::make_index_sequence<production_count>{});
+};
+} // namespace parsely::detail
+
+#endif // INCLUDE_PARSELY_UTILITY_GRAMMAR_TRAITS_HPP
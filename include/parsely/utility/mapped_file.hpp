@@ -0,0 +1,200 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_MAPPED_FILE_HPP
+#define INCLUDE_PARSELY_UTILITY_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PARSELY_HAS_MMAP 1
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace parsely
+{
+// The read-only contents of a file, mapped into memory where possible
+//
+// Regular files are mapped and the kernel is asked to read ahead sequentially, so parsing can start before the whole
+// file has been read and no second copy of it is made. Files that can't be mapped, such as pipes, are read into a
+// buffer instead. Moving a mapped_file doesn't move its contents, so views into them stay valid.
+class mapped_file
+{
+  public:
+    mapped_file() noexcept = default;
+
+    mapped_file(mapped_file&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+        , m_mapped(std::exchange(other.m_mapped, false))
+        , m_buffer(std::move(other.m_buffer))
+    {
+    }
+
+    auto operator=(mapped_file&& other) noexcept -> mapped_file&
+    {
+        mapped_file(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    mapped_file(mapped_file const&)                    = delete;
+    auto operator=(mapped_file const&) -> mapped_file& = delete;
+
+    ~mapped_file()
+    {
+#if defined(PARSELY_HAS_MMAP)
+        if (m_mapped)
+            ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+
+    void swap(mapped_file& other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_mapped, other.m_mapped);
+        m_buffer.swap(other.m_buffer);
+    }
+
+    // Opens the file at path and maps or reads its contents
+    static auto open(std::filesystem::path const& path) -> std::expected<mapped_file, std::error_code>
+    {
+#if defined(PARSELY_HAS_MMAP)
+        int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return std::unexpected(last_error());
+
+        mapped_file     file;
+        std::error_code error;
+        struct stat     status{};
+        if (::fstat(fd, &status) != 0)
+            error = last_error();
+        // Some regular files (e.g. in /proc) report a size of 0 but still have contents, so they are read instead
+        else if (!S_ISREG(status.st_mode) || status.st_size == 0
+                 || !file.map(fd, static_cast<std::size_t>(status.st_size)))
+            error = file.read(fd);
+        ::close(fd);
+
+        if (error)
+            return std::unexpected(error);
+        return file;
+#else
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+            return std::unexpected(std::make_error_code(std::errc::no_such_file_or_directory));
+
+        mapped_file file;
+        file.m_buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        if (stream.bad())
+            return std::unexpected(std::make_error_code(std::errc::io_error));
+        file.m_data = file.m_buffer.data();
+        file.m_size = file.m_buffer.size();
+        return file;
+#endif
+    }
+
+    // Returns the contents of the file
+    [[nodiscard]] auto text() const noexcept -> std::string_view { return std::string_view{m_data, m_size}; }
+
+    // Returns true if the contents are mapped rather than read into a buffer
+    [[nodiscard]] auto is_mapped() const noexcept -> bool { return m_mapped; }
+
+  private:
+    char const*       m_data   = nullptr;
+    std::size_t       m_size   = 0;
+    bool              m_mapped = false;
+    std::vector<char> m_buffer; // Contents of files that couldn't be mapped
+
+#if defined(PARSELY_HAS_MMAP)
+    static auto last_error() -> std::error_code { return std::error_code(errno, std::system_category()); }
+
+    auto map(int const fd, std::size_t const size) -> bool
+    {
+        int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+        flags |= MAP_POPULATE;
+#endif
+        void* const data = ::mmap(nullptr, size, PROT_READ, flags, fd, 0);
+        if (data == MAP_FAILED)
+            return false;
+#if defined(MADV_SEQUENTIAL)
+        ::madvise(data, size, MADV_SEQUENTIAL);
+#endif
+        m_data   = static_cast<char const*>(data);
+        m_size   = size;
+        m_mapped = true;
+        return true;
+    }
+
+    auto read(int const fd) -> std::error_code
+    {
+        constexpr std::size_t chunk_size = std::size_t{64} * 1024;
+
+        std::size_t size = 0;
+        while (true)
+        {
+            m_buffer.resize(size + chunk_size);
+            ::ssize_t const n = ::read(fd, m_buffer.data() + size, chunk_size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                return last_error();
+            if (n == 0)
+                break;
+            size += static_cast<std::size_t>(n);
+        }
+        m_buffer.resize(size);
+        m_data = m_buffer.data();
+        m_size = size;
+        return {};
+    }
+#endif
+};
+
+// The parse tree of a file together with the file contents it refers to
+//
+// The source text in the parse tree stays valid as long as the parsed_file is alive, even if it is moved.
+template<typename Node>
+class parsed_file
+{
+  public:
+    // Parses the contents of file with parse, which is called with a std::string_view of the contents
+    template<typename Parse>
+    parsed_file(mapped_file file, Parse const& parse)
+        : m_file(std::move(file))
+        , m_tree(parse(m_file.text()))
+    {
+    }
+
+    [[nodiscard]] auto tree() const noexcept -> Node const& { return m_tree; }
+    [[nodiscard]] auto file() const noexcept -> mapped_file const& { return m_file; }
+
+    [[nodiscard]] explicit operator bool() const { return static_cast<bool>(m_tree); }
+
+    auto operator*() const -> decltype(auto) { return *m_tree; }
+    auto operator->() const -> decltype(auto) { return m_tree.operator->(); }
+
+  private:
+    mapped_file m_file; // Declared first, so it is initialized before and destroyed after m_tree
+    Node        m_tree;
+};
+} // namespace parsely
+
+#undef PARSELY_HAS_MMAP
+
+#endif // INCLUDE_PARSELY_UTILITY_MAPPED_FILE_HPP
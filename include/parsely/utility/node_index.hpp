@@ -0,0 +1,135 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_NODE_INDEX_HPP
+#define INCLUDE_PARSELY_UTILITY_NODE_INDEX_HPP
+
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
+#include <parsely/utility/parse_tree_node.hpp>
+#include <parsely/utility/text.hpp>
+#include <parsely/utility/visitor.hpp>
+
+#include <structural/inplace_string.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace parsely
+{
+// An index of the symbol nodes of a parse tree by production, for queries that would otherwise walk the whole tree
+//
+// The index is built by a single traversal of the tree that records the nodes of all productions. The nodes of each
+// production are listed in the order of their begin offsets, with nested nodes of the same production after their
+// ancestors, so all nodes of a production are found in constant time and those beginning in a span of the input by a
+// binary search. Offsets are relative to the begin of the root, i.e. into the input for a whole parse tree. Only valid
+// nodes are indexed, so error nodes (see recover) aren't.
+//
+// The index refers to the nodes of the tree, which must outlive it and must not be modified until it is built again.
+template<typename Parser>
+class node_index
+{
+    using traits = detail::grammar_traits<Parser>;
+
+  public:
+    // Type of the symbol nodes of the production named Symbol
+    template<structural::inplace_string Symbol>
+    using node_type = parse_tree_node<Parser, detail::nonterminal_expr{Symbol}>;
+
+    constexpr node_index() = default;
+
+    template<typename Node>
+    constexpr explicit node_index(Node const& root)
+    {
+        build(root);
+    }
+
+    // Indexes the tree rooted at root, keeping the storage of the index
+    template<typename Node>
+    constexpr void build(Node const& root)
+    {
+        reset();
+        m_root  = &root;
+        m_begin = detail::as_chars(root.source_text).data();
+        traverse(root, [this]<typename Visited>(Visited const& node) { record(node); });
+    }
+
+    // Empties the index, keeping its storage
+    constexpr void reset()
+    {
+        m_root = nullptr;
+        for (auto& nodes : m_nodes)
+            nodes.clear();
+    }
+
+    // Returns true if the index was built for the tree rooted at root
+    template<typename Node>
+    [[nodiscard]] constexpr auto indexes(Node const& root) const -> bool
+    {
+        return m_root == &root;
+    }
+
+    // Returns the nodes of the production named Symbol, in the order of their begin offsets
+    template<structural::inplace_string Symbol>
+    [[nodiscard]] constexpr auto all() const
+    {
+        return view<Symbol>(entries<Symbol>());
+    }
+
+    // Returns the nodes of the production named Symbol that begin within span, in the order of their begin offsets
+    template<structural::inplace_string Symbol>
+    [[nodiscard]] constexpr auto starting_in(source_span const span) const
+    {
+        std::span<entry const> const nodes = entries<Symbol>();
+        auto const                   first = std::ranges::lower_bound(nodes, span.begin, {}, &entry::offset);
+        auto const                   last  = std::ranges::lower_bound(first, nodes.end(), span.end, {}, &entry::offset);
+        return view<Symbol>(std::span<entry const>{first, last});
+    }
+
+  private:
+    struct entry
+    {
+        std::size_t offset; // Offset of the begin of the node
+        void const* node;
+    };
+
+    template<structural::inplace_string Symbol>
+    constexpr auto entries() const -> std::span<entry const>
+    {
+        static_assert(traits::template production_index<Symbol> < traits::production_count, "Unknown production!");
+        return m_nodes[traits::template production_index<Symbol>];
+    }
+
+    template<structural::inplace_string Symbol>
+    static constexpr auto view(std::span<entry const> const nodes)
+    {
+        return nodes
+             | std::views::transform([](entry const& e) -> node_type<Symbol> const&
+                                     { return *static_cast<node_type<Symbol> const*>(e.node); });
+    }
+
+    template<typename Node>
+    constexpr void record(Node const& node)
+    {
+        if constexpr (is_nonterminal_node<Node>)
+        {
+            static constexpr std::size_t index = traits::index_of(Node::symbol); // Resolved once per production
+            auto const offset = static_cast<std::size_t>(detail::as_chars(node.source_text).data() - m_begin);
+            m_nodes[index].push_back(entry{.offset = offset, .node = &node});
+        }
+    }
+
+    void const* m_root  = nullptr; // Root of the indexed tree
+    char const* m_begin = nullptr; // Begin of the source text of the root
+
+    std::array<std::vector<entry>, traits::production_count> m_nodes; // Nodes of each production, by production id
+};
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_NODE_INDEX_HPP
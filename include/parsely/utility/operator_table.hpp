@@ -0,0 +1,208 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_OPERATOR_TABLE_HPP
+#define INCLUDE_PARSELY_UTILITY_OPERATOR_TABLE_HPP
+
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/text.hpp>
+
+#include <structural/tuple.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace parsely
+{
+// Refers to an operand or to an operation of an operator tree
+struct operator_term
+{
+    bool        operation = false; // True if the term is an operation, false if it is an operand
+    std::size_t index     = 0;     // Index of the operand or operation
+
+    constexpr auto operator==(operator_term const&) const -> bool = default;
+};
+
+// A binary operation of an operator tree
+template<typename Text>
+struct binary_operation
+{
+    std::size_t   op = 0;      // Index of the operator among those of all levels, in the order they are listed
+    operator_term lhs;         // Left operand
+    operator_term rhs;         // Right operand
+    Text          source_text; // Source text of both operands and the operator
+
+    constexpr auto operator==(binary_operation const&) const -> bool = default;
+};
+
+// The operands of an operator table and the binary operations on them
+//
+// Operations are stored after the operations they apply to, so the root of the tree is the last operation, or the
+// only operand if there is no operation.
+template<typename Operand, typename Text>
+struct operator_tree
+{
+    std::vector<Operand>                operands;   // Operands in input order
+    std::vector<binary_operation<Text>> operations; // Operations, ordered by precedence and associativity
+
+    constexpr auto operator==(operator_tree const&) const -> bool = default;
+
+    [[nodiscard]] constexpr auto root() const -> operator_term
+    {
+        if (operations.empty())
+            return operator_term{};
+        return operator_term{.operation = true, .index = operations.size() - 1};
+    }
+};
+
+namespace detail
+{
+// The operators of an operator table, flattened in the order they are listed
+template<operator_expr Expr>
+struct operator_table
+{
+    struct entry
+    {
+        std::string_view symbol;
+        std::size_t      precedence        = 0; // Index of the level
+        bool             right_associative = false;
+    };
+
+    static constexpr std::size_t level_count = std::tuple_size_v<decltype(Expr.levels)>;
+
+    static constexpr std::size_t size = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    { return (std::tuple_size_v<decltype(structural::get<is>(Expr.levels).operators)> + ... + 0); }(
+        std::make_index_sequence<level_count>{});
+
+    static constexpr auto entries = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    {
+        std::array<entry, size> result{};
+        std::size_t             i         = 0;
+        auto const              add_level = [&]<std::size_t level>(std::integral_constant<std::size_t, level>) constexpr
+        {
+            auto const& l = structural::get<level>(Expr.levels);
+            [&]<std::size_t... os>(std::index_sequence<os...>) constexpr
+            {
+                ((result[i++] = entry{
+                      .symbol            = std::string_view{structural::get<os>(l.operators).terminal},
+                      .precedence        = level,
+                      .right_associative = l.right_associative,
+                  }),
+                 ...);
+            }(std::make_index_sequence<std::tuple_size_v<decltype(l.operators)>>{});
+        };
+        (add_level(std::integral_constant<std::size_t, is>{}), ...);
+        return result;
+    }(std::make_index_sequence<level_count>{});
+
+    static_assert(size > 0, "Operator tables need at least one operator!");
+    static_assert(std::ranges::none_of(entries, [](entry const& e) { return e.symbol.empty(); }),
+                  "Operators can't be empty!");
+
+    // Indices of the entries, longest symbol first, so operators that start with other operators aren't shadowed
+    static constexpr auto match_order = []
+    {
+        std::array<std::size_t, size> result{};
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            // Insertion sort keeps operators of the same length in the order they are listed
+            std::size_t j = i;
+            for (; j > 0 && entries[result[j - 1]].symbol.size() < entries[i].symbol.size(); --j)
+                result[j] = result[j - 1];
+            result[j] = i;
+        }
+        return result;
+    }();
+
+    // Returns the index of the operator that input starts with, or size if there is none
+    static constexpr auto match(std::string_view const input) -> std::size_t
+    {
+        for (std::size_t const i : match_order)
+        {
+            if (input.starts_with(entries[i].symbol))
+                return i;
+        }
+        return size;
+    }
+
+    // Checks whether the operator op, which precedes the operator next, applies to the operand between them
+    static constexpr auto binds_first(std::size_t const op, std::size_t const next) -> bool
+    {
+        if (entries[op].precedence != entries[next].precedence)
+            return entries[op].precedence > entries[next].precedence;
+        return !entries[op].right_associative;
+    }
+};
+
+// Orders the operators of an operator table by precedence and associativity in a single pass
+//
+// op(i) is the index of the operator between the operands i and i + 1 of the count operators, and span(i) is the range
+// of input spanned by operand i. The resulting operations replace the contents of operations, reusing its storage.
+//
+// Operands that aren't reduced yet form a stack of values, each spanning a range of adjacent operands, with the pending
+// operators between them. A value is an operand if it spans one, and the last operation written for its range
+// otherwise. Since the operations of each value are written before those of the values above it, the whole stack is
+// given by the first operands of its values. These are kept in the slots at the back of operations that aren't
+// written yet: after r operations, at most count - r values but the bottom one remain, so both never overlap.
+template<operator_expr Expr, typename Text>
+constexpr void build_operations(std::size_t const                    count,
+                                auto const&                          op,
+                                auto const&                          span,
+                                std::string_view const               input,
+                                std::vector<binary_operation<Text>>& operations)
+{
+    using table = operator_table<Expr>;
+
+    operations.resize(count);
+    std::size_t written = 0; // Number of operations written to the front of operations
+    std::size_t pushed  = 0; // Number of values on the stack above the bottom one, which starts at operand 0
+
+    auto const first_operand = [&](std::size_t const value) { return value == 0 ? 0 : operations[count - value].op; };
+
+    // A value spanning the operands [first, after) consists of after - first - 1 operations, the last of which is its
+    // term
+    auto const term = [](std::size_t const first, std::size_t const after, std::size_t const last_operation)
+    {
+        if (after - first == 1)
+            return operator_term{.index = first};
+        return operator_term{.operation = true, .index = last_operation};
+    };
+
+    // Reduces the two values on top of the stack, whose upper one ends before operand end
+    auto const reduce = [&](std::size_t const end) constexpr
+    {
+        std::size_t const rhs_first = first_operand(pushed);
+        std::size_t const lhs_first = first_operand(pushed - 1);
+        --pushed;
+
+        auto const source   = source_span{.begin = span(lhs_first).begin, .end = span(end - 1).end};
+        operations[written] = binary_operation<Text>{
+            .op          = op(rhs_first - 1),
+            .lhs         = term(lhs_first, rhs_first, written - (end - rhs_first - 1) - 1),
+            .rhs         = term(rhs_first, end, written - 1),
+            .source_text = from_chars<Text>(input.substr(source.begin, source.size())),
+        };
+        ++written;
+    };
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        while (pushed != 0 && table::binds_first(op(first_operand(pushed) - 1), op(i)))
+            reduce(i + 1);
+        ++pushed;
+        operations[count - pushed].op = i + 1;
+    }
+    while (pushed != 0)
+        reduce(count + 1);
+}
+} // namespace detail
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_OPERATOR_TABLE_HPP
@@ -0,0 +1,116 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_PARSE_BUDGET_HPP
+#define INCLUDE_PARSELY_UTILITY_PARSE_BUDGET_HPP
+
+#include <parsely/utility/recognizer.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+namespace parsely
+{
+// Limits on the work done to parse a single input
+//
+// Backtracking grammars may take exponential time on crafted input. Parsing with a budget aborts as soon as one of the
+// limits is exceeded, so the worst-case latency of a parse is bounded by the limits rather than by the input.
+struct parse_budget
+{
+    static constexpr std::size_t unlimited = std::numeric_limits<std::size_t>::max();
+
+    std::size_t max_steps = unlimited; // Productions entered, including attempts that are backtracked
+    std::size_t max_depth = unlimited; // Nesting depth of productions, which bounds the stack used for parsing
+    std::size_t max_nodes = unlimited; // Matched productions, an upper bound on the symbol nodes of the parse tree
+};
+
+// The limit of a parse_budget that was exceeded
+enum class budget_limit
+{
+    steps,
+    depth,
+    nodes,
+};
+
+// The result of parsing an input that exceeded its budget
+struct budget_exceeded
+{
+    budget_limit limit  = budget_limit::steps;
+    std::size_t  offset = 0; // Offset into the input of the production that exceeded the limit
+
+    constexpr auto operator==(budget_exceeded const&) const -> bool = default;
+};
+
+namespace detail
+{
+// A decision log forwarding to Log, which enforces a parse_budget while recognizing input
+//
+// Recognizers call enter() before matching a production and leave() after it, if enter() succeeded. Once a limit is
+// exceeded, every production fails to match without consuming input, so the recognizer unwinds quickly.
+template<typename Log>
+class budget_log
+{
+  public:
+    constexpr budget_log(Log& log, parse_budget const budget, std::string_view const input)
+        : m_log(log)
+        , m_budget(budget)
+        , m_input(input)
+    {
+    }
+
+    [[nodiscard]] constexpr auto mark() const -> std::size_t { return m_log.mark(); }
+    constexpr void               push(std::size_t const decision) { m_log.push(decision); }
+    constexpr void               set(std::size_t const at, std::size_t const decision) { m_log.set(at, decision); }
+    constexpr void               truncate(std::size_t const at) { m_log.truncate(at); }
+    constexpr void recover(std::size_t const at, std::string_view const skipped) { m_log.recover(at, skipped); }
+
+    // Checks whether the production starting at input may be matched
+    constexpr auto enter(std::string_view const input) -> bool
+    {
+        if (m_exceeded)
+            return false;
+        if (m_steps == m_budget.max_steps)
+            return exceed(budget_limit::steps, input);
+        if (m_depth == m_budget.max_depth)
+            return exceed(budget_limit::depth, input);
+        ++m_steps;
+        ++m_depth;
+        return true;
+    }
+
+    constexpr void leave(std::string_view const input, bool const matched)
+    {
+        --m_depth;
+        if (matched && !m_exceeded && m_nodes++ == m_budget.max_nodes)
+            exceed(budget_limit::nodes, input);
+    }
+
+    [[nodiscard]] constexpr auto exhausted() const -> bool { return m_exceeded.has_value(); }
+    [[nodiscard]] constexpr auto exceeded() const -> std::optional<budget_exceeded> const& { return m_exceeded; }
+
+  private:
+    constexpr auto exceed(budget_limit const limit, std::string_view const input) -> bool
+    {
+        m_exceeded = budget_exceeded{
+            .limit  = limit,
+            .offset = static_cast<std::size_t>(input.data() - m_input.data()),
+        };
+        return false;
+    }
+
+    Log&                           m_log;
+    parse_budget                   m_budget;
+    std::string_view               m_input; // The whole input, to compute offsets
+    std::size_t                    m_steps = 0;
+    std::size_t                    m_depth = 0;
+    std::size_t                    m_nodes = 0;
+    std::optional<budget_exceeded> m_exceeded;
+};
+} // namespace detail
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_PARSE_BUDGET_HPP
@@ -0,0 +1,132 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_PARSE_CONTEXT_HPP
+#define INCLUDE_PARSELY_UTILITY_PARSE_CONTEXT_HPP
+
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/node_index.hpp>
+#include <parsely/utility/parse_tree_node.hpp>
+#include <parsely/utility/parser_creator.hpp>
+#include <parsely/utility/recognizer.hpp>
+#include <parsely/utility/source_index.hpp>
+#include <parsely/utility/structural_index.hpp>
+#include <parsely/utility/text.hpp>
+
+#include <structural/inplace_string.hpp>
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace parsely
+{
+// Reusable storage for parsing many inputs with the same parser
+//
+// The parse tree of the last input is kept alive and overwritten by the next call to parse(). Nested nodes and
+// repetition buffers are reused wherever the new tree has the same shape as the old one, and alternatives that fail to
+// match are never built, so parsing similarly shaped inputs doesn't allocate once the context has warmed up.
+//
+// A context must not be used by multiple threads at once, but it is cheap to keep one per thread.
+template<typename Parser, structural::inplace_string Symbol = Parser::start_symbol>
+class parse_context
+{
+  public:
+    using node_type = parse_tree_node<Parser, detail::nonterminal_expr{Symbol}>;
+
+    // Parses the given input string and returns the parse tree, which stays valid until the next call to parse() or
+    // clear()
+    //
+    // If parsing fails, only the validity and the consumed source text of the returned node are meaningful.
+    constexpr auto parse(detail::text_t<Parser> const input) -> node_type const&
+    {
+        m_input = detail::as_chars(input);
+        m_index.reset(m_input);
+        detail::parse_into(m_tree, m_input, m_decisions, m_structure);
+        m_nodes.reset();
+        return m_tree;
+    }
+
+    // Returns the parse tree of the last input
+    [[nodiscard]] constexpr auto tree() const noexcept -> node_type const& { return m_tree; }
+
+    // Returns the spans of the last input that were skipped to recover from failures (see recover), in input order
+    //
+    // Each span is the source text of an error node in the parse tree.
+    [[nodiscard]] constexpr auto errors() const -> std::vector<source_span>
+    {
+        std::vector<source_span> result;
+        for (std::string_view const skipped : m_decisions.recoveries())
+        {
+            auto const begin = static_cast<std::size_t>(skipped.data() - m_input.data());
+            result.push_back(source_span{.begin = begin, .end = begin + skipped.size()});
+        }
+        return result;
+    }
+
+    // Returns the line and column of an offset into the last input, such as the begin of an error span
+    //
+    // The line table of the input is built by the first call after each parse, so error-free inputs don't pay for it.
+    [[nodiscard]] constexpr auto location(std::size_t const offset) -> source_location
+    {
+        return m_index.location(offset);
+    }
+
+    // Returns the locations of the begins of errors(), in input order
+    [[nodiscard]] constexpr auto error_locations() -> std::vector<source_location>
+    {
+        std::vector<source_location> result;
+        for (source_span const span : errors())
+            result.push_back(location(span.begin));
+        return result;
+    }
+
+    // Returns the nodes of the production named NodeSymbol in the parse tree of the last input, in input order
+    //
+    // The nodes of all productions are indexed by the first query after each parse (see node_index), so queries don't
+    // traverse the tree.
+    template<structural::inplace_string NodeSymbol>
+    [[nodiscard]] constexpr auto all()
+    {
+        return nodes().template all<NodeSymbol>();
+    }
+
+    // Returns the nodes of the production named NodeSymbol in the parse tree of the last input that begin within span
+    template<structural::inplace_string NodeSymbol>
+    [[nodiscard]] constexpr auto starting_in(source_span const span)
+    {
+        return nodes().template starting_in<NodeSymbol>(span);
+    }
+
+    // Releases all storage held by the context
+    constexpr void clear()
+    {
+        m_tree      = node_type{};
+        m_decisions = detail::decision_log{};
+        m_structure = structural_index{};
+        m_input     = {};
+        m_index     = source_index{};
+        m_nodes     = node_index<Parser>{};
+    }
+
+  private:
+    // Returns the index of the parse tree of the last input, building it if needed
+    constexpr auto nodes() -> node_index<Parser> const&
+    {
+        if (!m_nodes.indexes(m_tree)) // Also rebuilds the index of copies of the context
+            m_nodes.build(m_tree);
+        return m_nodes;
+    }
+
+    node_type            m_tree;
+    detail::decision_log m_decisions;
+    structural_index     m_structure; // Quotes of the last input, if the parser scans its structure
+    std::string_view     m_input; // The last input, viewed as chars
+    source_index         m_index; // Lines of the last input, built on demand
+    node_index<Parser>   m_nodes; // Symbol nodes of the parse tree, built on demand
+};
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_PARSE_CONTEXT_HPP
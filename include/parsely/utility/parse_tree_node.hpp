@@ -7,8 +7,15 @@
 #define INCLUDE_PARSELY_UTILITY_PARSE_TREE_NODE_HPP
 
 #include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
 #include <parsely/utility/indirect.hpp>
+#include <parsely/utility/operator_table.hpp>
+#include <parsely/utility/parser_policies.hpp>
+#include <parsely/utility/subtree_hash.hpp>
 
+#include <array>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace parsely
@@ -27,9 +34,9 @@ struct parse_tree_node<Parser, Expr>
                                      return t();
                                  }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.sequence)>>{}));
 
-    bool             valid = false; // True if parsing successful
-    std::string_view source_text;   // Consumed source text
-    nested_type      node_sequence; // Tuple of more parse_tree_nodes
+    bool                   valid = false; // True if parsing successful
+    detail::text_t<Parser> source_text;   // Consumed source text
+    nested_type            node_sequence; // Tuple of more parse_tree_nodes
 
     constexpr auto operator==(parse_tree_node const&) const -> bool = default;
 
@@ -59,9 +66,9 @@ struct parse_tree_node<Parser, Expr>
                                      return t();
                                  }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.alternatives)>>{}));
 
-    bool             valid = false;     // True if parsing successful
-    std::string_view source_text;       // Consumed source text
-    nested_type      node_alternatives; // Variant containing the matched parse_tree_node
+    bool                   valid = false;     // True if parsing successful
+    detail::text_t<Parser> source_text;       // Consumed source text
+    nested_type            node_alternatives; // Variant containing the matched parse_tree_node
 
     constexpr auto operator==(parse_tree_node const&) const -> bool = default;
 
@@ -105,9 +112,9 @@ struct parse_tree_node<Parser, Expr>
     using parser_type = Parser;
     using nested_type = std::vector<parse_tree_node<Parser, Expr.element>>;
 
-    bool             valid = false;    // True if parsing successful
-    std::string_view source_text;      // Consumed source text
-    nested_type      node_repetitions; // vector of more parse_tree_nodes
+    bool                   valid = false;    // True if parsing successful
+    detail::text_t<Parser> source_text;      // Consumed source text
+    nested_type            node_repetitions; // vector of more parse_tree_nodes
 
     constexpr auto operator==(parse_tree_node const&) const -> bool = default;
 
@@ -129,8 +136,8 @@ struct parse_tree_node<Parser, Expr>
     using parser_type = Parser;
     static constexpr std::string_view terminal = Expr.terminal;
 
-    bool             valid = false; // True if parsing successful
-    std::string_view source_text;   // Consumed source text
+    bool                   valid = false; // True if parsing successful
+    detail::text_t<Parser> source_text;   // Consumed source text
 
     constexpr auto operator==(parse_tree_node const&) const -> bool = default;
 
@@ -141,27 +148,29 @@ struct parse_tree_node<Parser, Expr>
 template<typename Parser, detail::nonterminal_expr Expr>
 struct parse_tree_node<Parser, Expr>
 {
-    using parser_type = Parser;
-    using nested_type = decltype([]() constexpr
-                                 {
-                                     static constexpr std::size_t index = []<std::size_t... is>(std::index_sequence<is...>) constexpr
-                                     {
-                                         std::size_t i = 0;
-                                         ((i = is, structural::get<is>(Parser::s_grammar.productions).symbol == Expr.symbol) || ...);
-                                         return i;
-                                     }(std::make_index_sequence<std::tuple_size_v<decltype(Parser::s_grammar.productions)>>{});
-
-                                     static constexpr auto expression = structural::get<index>(Parser::s_grammar.productions).expression;
+    // False if the production isn't captured, in which case the node has no nested node (see capture)
+    static constexpr bool captured = []
+    {
+        using traits = detail::grammar_traits<Parser>;
+        return traits::captured[traits::template production_index<Expr.symbol>];
+    }();
 
-                                     using t = indirect<parse_tree_node<Parser, expression>>;
-                                     return t();
-                                 }());
+    using parser_type = Parser;
+    using nested_type = std::conditional_t<
+        captured,
+        detail::nested_storage_t<
+            Parser,
+            parse_tree_node<Parser, detail::grammar_traits<Parser>::template expression<Expr.symbol>>>,
+        detail::span_node>;
+    using hash_type = detail::subtree_hash_t<Parser>; // std::uint64_t if the parser hashes subtrees, else an empty type
 
     static constexpr std::string_view symbol = Expr.symbol;
 
-    bool             valid = false; // True if parsing successful
-    std::string_view source_text;   // Consumed source text
-    nested_type      nested;        // Indirectly stored result parse_tree_node - may be null iif !valid
+    bool                   valid     = false; // True if parsing successful
+    bool                   recovered = false; // True if parsing failed and the source text was skipped (see recover)
+    hash_type              hash{};            // Hash of the subtree, compared first (see hashed_tree)
+    detail::text_t<Parser> source_text;       // Consumed source text
+    nested_type            nested;            // Indirectly stored result parse_tree_node - may be null iif !valid
 
     constexpr auto operator==(parse_tree_node const&) const -> bool = default;
 
@@ -181,14 +190,56 @@ template<typename Parser, detail::inbuilt_expr Expr>
 struct parse_tree_node<Parser, Expr>
 {
     using parser_type = Parser;
-    bool             valid = false; // True if parsing successful
-    std::string_view source_text;   // Consumed source text
+    bool                   valid = false; // True if parsing successful
+    detail::text_t<Parser> source_text;   // Consumed source text
 
     constexpr auto operator==(parse_tree_node const&) const -> bool = default;
 
     constexpr explicit operator bool() const { return valid; };
 };
 
+// Parse tree node used for operator tables
+template<typename Parser, detail::operator_expr Expr>
+struct parse_tree_node<Parser, Expr>
+{
+    using parser_type    = Parser;
+    using operand_type   = parse_tree_node<Parser, Expr.operand>;
+    using operation_type = binary_operation<detail::text_t<Parser>>;
+
+    // Symbols of the operators, in the order they are listed; indexed by operation_type::op
+    static constexpr auto operators = []
+    {
+        using table = detail::operator_table<Expr>;
+        std::array<std::string_view, table::size> result{};
+        for (std::size_t i = 0; i < table::size; ++i)
+            result[i] = table::entries[i].symbol;
+        return result;
+    }();
+
+    bool                        valid = false;   // True if parsing successful
+    detail::text_t<Parser>      source_text;     // Consumed source text
+    std::vector<operand_type>   node_operands;   // Operand parse_tree_nodes in input order
+    std::vector<operation_type> node_operations; // Operations, each after the operations it applies to
+
+    constexpr auto operator==(parse_tree_node const&) const -> bool = default;
+
+    constexpr explicit operator bool() const { return valid; };
+
+    // Returns the term that applies all operations, i.e. the last operation, or the only operand if there is none
+    [[nodiscard]] constexpr auto root() const -> operator_term
+    {
+        if (node_operations.empty())
+            return operator_term{};
+        return operator_term{.operation = true, .index = node_operations.size() - 1};
+    }
+
+    constexpr auto operand(operator_term const term) const -> operand_type const& { return node_operands[term.index]; }
+    constexpr auto operation(operator_term const term) const -> operation_type const&
+    {
+        return node_operations[term.index];
+    }
+};
+
 #define ELVIS_PARSELY_MAKE_PARSE_TREE_NODE_CONCEPT(NODE)                                                               \
     template<typename Node>                                                                                            \
     struct is_##NODE##_parse_tree_node : std::false_type                                                               \
@@ -212,9 +263,14 @@ ELVIS_PARSELY_MAKE_PARSE_TREE_NODE_CONCEPT(rep)
 ELVIS_PARSELY_MAKE_PARSE_TREE_NODE_CONCEPT(nonterminal)
 ELVIS_PARSELY_MAKE_PARSE_TREE_NODE_CONCEPT(terminal)
 ELVIS_PARSELY_MAKE_PARSE_TREE_NODE_CONCEPT(inbuilt)
+ELVIS_PARSELY_MAKE_PARSE_TREE_NODE_CONCEPT(operator)
 
 #undef ELVIS_PARSELY_MAKE_PARSE_TREE_NODE_CONCEPT
 
+// Satisfied by parse tree nodes generated from the nonterminal Symbol
+template<typename Node, structural::inplace_string Symbol>
+concept is_symbol_node = is_nonterminal_node<Node> && Node::symbol == std::string_view{Symbol};
+
 } // namespace parsely
 
 #endif // INCLUDE_PARSELY_UTILITY_PARSE_TREE_NODE_HPP
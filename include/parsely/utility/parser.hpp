@@ -6,39 +6,67 @@
 #ifndef GRAMMAR_PARSER_HPP
 #define GRAMMAR_PARSER_HPP
 
+#include <parsely/runtime/static_program.hpp>
+#include <parsely/runtime/vm.hpp>
+#include <parsely/utility/ast_mapper.hpp>
+#include <parsely/utility/event_emitter.hpp>
+#include <parsely/utility/grammar_analysis.hpp>
 #include <parsely/utility/grammar_ast.hpp>
 #include <parsely/utility/grammar_parser.hpp>
 #include <parsely/utility/indirect.hpp>
+#include <parsely/utility/mapped_file.hpp>
+#include <parsely/utility/parse_budget.hpp>
 #include <parsely/utility/parse_tree_node.hpp>
 #include <parsely/utility/parser_creator.hpp>
+#include <parsely/utility/parser_policies.hpp>
+#include <parsely/utility/record_view.hpp>
+#include <parsely/utility/semantic_action.hpp>
+#include <parsely/utility/text.hpp>
 
 #include <structural/inplace_string.hpp>
 
+#include <algorithm>
+#include <expected>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+
 namespace parsely
 {
 namespace detail
 {
-template<structural::inplace_string Grammar>
-constexpr auto create_failure_string(auto /*parse_tree*/) -> std::string
-{
-    // TODO: Implement dynamic error string creation
-    return "The grammar is invalid.";
-}
+// Parses the grammar description once and structuralizes it; invalid descriptions fail to compile (see
+// structuralizer<grammar_parse_tree_node_grammar>)
 template<structural::inplace_string Grammar>
 consteval auto parse_grammar()
 {
-    static_assert(grammar_parser<Grammar>::parse().valid,
-                  create_failure_string<Grammar>(grammar_parser<Grammar>::parse()));
     return STRUCTURALIZE(grammar_parser<Grammar>::parse());
 }
-} // namespace detail
 
-// A parser for the given grammar
+// Defines the grammar of a parser by its description (see parser)
 template<structural::inplace_string Grammar>
-struct parser
+struct grammar_description
+{
+    static constexpr auto grammar = parse_grammar<Grammar>();
+};
+} // namespace detail
+
+// A parser for the grammar defined by Definition
+//
+// Definition has a static member grammar, which holds the grammar as built by detail::make_grammar. Grammars are
+// usually given by their description instead (see parser), or generated from a grammar file by parsely_generate (see
+// runtime::generate_source). The behavior of the parser can be customized by passing policies (e.g. shared_tree).
+template<typename Definition, typename... Policies>
+struct basic_parser
 {
+    template<typename T>
+    using nested_storage = typename detail::select_nested_storage<T, Policies...>::type;
+
+    // The type of input accepted by the parser and of the source text in its parse trees
+    using text_type = typename detail::select_text<Policies...>::type;
+
   private:
-    static constexpr auto        s_grammar         = detail::parse_grammar<Grammar>();
+    static constexpr auto        s_grammar         = Definition::grammar;
     static constexpr std::size_t s_num_productions = std::tuple_size_v<decltype(s_grammar.productions)>;
 
     template<typename, auto>
@@ -47,21 +75,220 @@ struct parser
     template<typename Parser, detail::nonterminal_expr Expr>
     friend constexpr auto detail::parse_nonterminal(std::string_view input) -> parse_tree_node<Parser, Expr>;
 
+    template<typename>
+    friend struct detail::grammar_traits;
+
+    static constexpr bool scans_structure = detail::has_policy<structural_scan, Policies...>;
+    static constexpr bool hashes_subtrees = detail::has_policy<hashed_tree, Policies...>;
+
+    static constexpr auto sync_point(std::string_view const symbol) -> std::string_view
+    {
+        return detail::select_sync_point<Policies...>(symbol);
+    }
+
+    static constexpr auto captures(std::string_view const symbol) -> bool
+    {
+        return detail::select_captured<Policies...>(symbol);
+    }
+
+    static consteval void check_policies()
+    {
+        if constexpr (detail::has_policy<require_predictive, Policies...>)
+        {
+            static_assert(detail::grammar_analysis<basic_parser>::backtracking_productions.empty(),
+                          detail::grammar_analysis<basic_parser>::backtracking_message());
+        }
+        constexpr auto is_production = [](std::string_view const symbol)
+        { return detail::grammar_traits<basic_parser>::index_of(symbol) < s_num_productions; };
+        static_assert((detail::capture_policy<Policies>::all_symbols(is_production) && ...),
+                      "Captured symbol doesn't name a production!");
+    }
+
   public:
+    // The symbol of the production first mentioned in the grammar
+    static constexpr auto start_symbol = get<0>(s_grammar.productions).symbol;
+
+    // Returns the symbols of the productions that need backtracking
+    //
+    // All other productions are parsed predictively, choosing between alternatives by looking at the next char of the
+    // input only. Productions are analyzed individually, so predictive productions may refer to backtracking ones.
+    static consteval auto backtracking_productions()
+    {
+        return detail::grammar_analysis<basic_parser>::backtracking_productions;
+    }
+
     // Parses the given input string and returns a parse tree
     //
     // The Symbol NTTP indicates which production to use for parsing. By default, the production first mentioned in the
     // grammar is used.
-    template<structural::inplace_string Symbol = get<0>(s_grammar.productions).symbol>
-    static constexpr auto parse(std::string_view const input)
-        -> parse_tree_node<parser, detail::nonterminal_expr{Symbol}>
+    template<structural::inplace_string Symbol = start_symbol>
+    static constexpr auto parse(text_type const input)
+        -> parse_tree_node<basic_parser, detail::nonterminal_expr{Symbol}>
+    {
+        check_policies();
+        return detail::parse_nonterminal<basic_parser, detail::nonterminal_expr{Symbol}>(detail::as_chars(input));
+    }
+
+    // Parses the given input string like parse(), but aborts as soon as it exceeds one of the limits of budget
+    //
+    // Enforcing the budget costs a few comparisons per production, so it can be left enabled for untrusted input.
+    // Returns budget_exceeded instead of a parse tree if parsing was aborted; failing to match within the budget still
+    // yields an invalid parse tree.
+    template<structural::inplace_string Symbol = start_symbol>
+    static constexpr auto parse(text_type const input, parse_budget const budget)
+        -> std::expected<parse_tree_node<basic_parser, detail::nonterminal_expr{Symbol}>, budget_exceeded>
+    {
+        check_policies();
+        return detail::parse_expression<basic_parser, detail::nonterminal_expr{Symbol}>(detail::as_chars(input),
+                                                                                        budget);
+    }
+
+    // Index of the production named Symbol, which identifies it in the nodes of dynamic trees
+    template<structural::inplace_string Symbol>
+    static constexpr std::size_t production_index =
+        detail::grammar_traits<basic_parser>::template production_index<Symbol>;
+
+    // Parses the given input string into a dynamic_tree instead of a parse_tree_node
+    //
+    // The grammar is compiled into a program for the parsing virtual machine, which emits one uniform node per matched
+    // production, holding its production_index, its span of the input and the range of its descendants in a single
+    // array. None of the per-expression node types and parse functions of parse() are instantiated, so large grammars
+    // compile faster into smaller binaries. Operator tables only emit the nodes of their operands.
+    template<structural::inplace_string Symbol = start_symbol>
+    static constexpr auto parse_dynamic(text_type const input) -> runtime::dynamic_tree
+    {
+        runtime::dynamic_tree tree;
+        runtime::vm           machine;
+        parse_dynamic_into<Symbol>(tree, machine, input);
+        return tree;
+    }
+
+    // Parses the given input string into an existing dynamic_tree, reusing its storage and that of the given machine
+    template<structural::inplace_string Symbol = start_symbol>
+    static constexpr void parse_dynamic_into(runtime::dynamic_tree& tree, runtime::vm& machine, text_type const input)
+    {
+        check_policies();
+        static_assert(production_index<Symbol> < s_num_productions, "Unknown symbol!");
+        static_assert(std::ranges::all_of(detail::grammar_traits<basic_parser>::sync_points,
+                                          [](std::string_view const sync) { return sync.empty(); }),
+                      "Recovering from failures isn't supported by dynamic trees!");
+        machine.run(runtime::static_program<basic_parser, true>{},
+                    production_index<Symbol>,
+                    detail::as_chars(input),
+                    tree);
+    }
+
+    // Returns the symbol of the production that a node of a dynamic tree was generated from
+    [[nodiscard]] static constexpr auto symbol(runtime::dynamic_node const& node) -> std::string_view
+    {
+        return detail::grammar_traits<basic_parser>::symbols[node.production];
+    }
+
+    // Checks whether the given input string matches the production named Symbol, without building a parse tree
+    //
+    // The grammar is compiled into a program for the parsing virtual machine, which doesn't recurse and reuses its
+    // stacks, so large inputs can be recognized in constant expressions within the compiler's default limits. The
+    // result holds the number of chars matched, or the furthest position reached if the input doesn't match.
+    template<structural::inplace_string Symbol = start_symbol>
+    static constexpr auto recognize(text_type const input) -> runtime::recognition
     {
-        return detail::parse_nonterminal<parser, detail::nonterminal_expr{Symbol}>(input);
+        check_policies();
+        constexpr std::size_t index = detail::grammar_traits<basic_parser>::template production_index<Symbol>;
+        static_assert(index < s_num_productions, "Unknown symbol!");
+        runtime::vm machine;
+        return machine.recognize(runtime::static_program<basic_parser>{}, index, detail::as_chars(input));
+    }
+
+    // Parses the contents of the file at path and returns them together with the parse tree
+    //
+    // The file is memory-mapped where possible, so its contents aren't copied into a separate buffer. The result owns
+    // the file contents, so the source text in the parse tree stays valid as long as the result is alive.
+    template<structural::inplace_string Symbol = start_symbol>
+    static auto parse_file(std::filesystem::path const& path)
+        -> std::expected<parsed_file<parse_tree_node<basic_parser, detail::nonterminal_expr{Symbol}>>, std::error_code>
+    {
+        check_policies();
+        using node_type = parse_tree_node<basic_parser, detail::nonterminal_expr{Symbol}>;
+
+        auto const parse_contents = [](std::string_view const contents) -> node_type
+        { return detail::parse_nonterminal<basic_parser, detail::nonterminal_expr{Symbol}>(contents); };
+        return mapped_file::open(path).transform([&](mapped_file&& file)
+                                                 { return parsed_file<node_type>(std::move(file), parse_contents); });
+    }
+
+    // Returns a lazy range of the parse trees of consecutive matches of the production named Symbol in input
+    //
+    // Each match is parsed when the range is advanced to it, so memory use doesn't grow with the input (see
+    // record_view).
+    template<structural::inplace_string Symbol = start_symbol>
+    static constexpr auto records(text_type const input) -> record_view<basic_parser, Symbol>
+    {
+        check_policies();
+        static_assert(detail::grammar_traits<basic_parser>::template production_index<Symbol> < s_num_productions,
+                      "Unknown symbol!");
+        return record_view<basic_parser, Symbol>(input);
+    }
+
+    // Parses the given input string and reports the parse to sink as events instead of building a parse tree
+    //
+    // The sink may provide `enter(symbol)` and `leave(symbol, source_text)` (or `leave(symbol)`), which are called
+    // before and after each matched production, and `token(source_text)`, which is called for each non-empty terminal
+    // and inbuilt match. Only the committed parse is reported: nothing is reported if the input doesn't match, and
+    // attempts that are backtracked are never reported. The input is matched once, and events are buffered only while
+    // an enclosing attempt may still fail. Productions that aren't captured (see capture) are reported without the
+    // events of their expressions. Returns whether the input matched and the length of the match.
+    template<structural::inplace_string Symbol = start_symbol, typename Sink>
+    static constexpr auto parse_events(text_type const input, Sink&& sink) -> detail::match_result
+    {
+        check_policies();
+        return detail::emit_events<basic_parser, detail::nonterminal_expr{Symbol}>(detail::as_chars(input), sink);
+    }
+
+    // Parses the given input string and folds it into a value using the given semantic actions
+    //
+    // No parse tree is built. Instead, the input is recognized first, and each production with a semantic action is
+    // folded into the action's value type from the recorded decisions, so actions only run for productions that are
+    // part of the parse, once each. Productions without an action fold into their source text, so only their lengths
+    // are recorded.
+    template<structural::inplace_string Symbol = start_symbol, typename... Actions>
+    static constexpr auto fold(text_type const input, Actions const&... actions)
+    {
+        check_policies();
+        static_assert(detail::grammar_traits<basic_parser>::template production_index<Symbol> < s_num_productions,
+                      "Unknown symbol!");
+        using actions_type = std::tuple<Actions const&...>;
+        return detail::map_expression<basic_parser,
+                                      detail::nonterminal_expr{Symbol},
+                                      detail::unmapped_productions::text>(detail::as_chars(input),
+                                                                          actions_type{actions...});
+    }
+
+    // Parses the given input string and maps it directly into an AST using the given semantic actions
+    //
+    // Like fold, but productions without an action map into an ast_node holding their source text and the mapped value
+    // of their expression, so actions of nested productions still apply.
+    template<structural::inplace_string Symbol = start_symbol, typename... Actions>
+    static constexpr auto map(text_type const input, Actions const&... actions)
+    {
+        check_policies();
+        static_assert(detail::grammar_traits<basic_parser>::template production_index<Symbol> < s_num_productions,
+                      "Unknown symbol!");
+        using actions_type = std::tuple<Actions const&...>;
+        return detail::map_expression<basic_parser,
+                                      detail::nonterminal_expr{Symbol},
+                                      detail::unmapped_productions::nodes>(detail::as_chars(input),
+                                                                           actions_type{actions...});
     }
 
     // Parses the given input string
-    static constexpr auto operator()(std::string_view const input) { return parse<>(input); }
+    static constexpr auto operator()(text_type const input) { return parse<>(input); }
 };
+
+// A parser for the grammar given by its description
+//
+// The description is parsed at compile time, so invalid descriptions fail to compile. See basic_parser.
+template<structural::inplace_string Grammar, typename... Policies>
+using parser = basic_parser<detail::grammar_description<Grammar>, Policies...>;
 } // namespace parsely
 
 #endif // GRAMMAR_PARSER_HPP
@@ -7,176 +7,464 @@
 #define INCLUDE_PARSELY_UTILITY_PARSER_CREATOR_HPP
 
 #include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
+#include <parsely/utility/operator_table.hpp>
+#include <parsely/utility/parse_budget.hpp>
 #include <parsely/utility/parse_tree_node.hpp>
+#include <parsely/utility/recognizer.hpp>
+#include <parsely/utility/structural_index.hpp>
+#include <parsely/utility/subtree_hash.hpp>
+#include <parsely/utility/text.hpp>
+#include <parsely/utility/utf8.hpp>
+
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <variant>
+#include <vector>
 
 namespace parsely::detail
 {
+// Builds the parse tree for input in place, reusing the storage already held by node
+//
+// Input must be known to match Expr, and decisions must start with the decisions recorded while recognizing it. Each
+// builder consumes the decisions of its expression, so only the alternatives that match are built, and nested nodes
+// and repetition buffers of node are overwritten rather than reallocated where possible.
 template<typename Parser, auto Expr>
-struct parser_creator;
+struct builder;
+
+constexpr auto pop_decision(std::span<std::size_t const>& decisions) -> std::size_t
+{
+    std::size_t const decision = decisions.front();
+    decisions                  = decisions.subspan(1);
+    return decision;
+}
+
+// Mixes the subtree of a production's parse tree into hasher, down to its child symbol nodes, whose hashes are known
+//
+// Terminals are skipped as their source text is given by the grammar, so together with the choices of alternatives and
+// the numbers of repetitions and operands, the mixed values determine the subtree.
+template<typename Node>
+constexpr void mix_subtree(subtree_hasher& hasher, Node const& node)
+{
+    if constexpr (is_nonterminal_node<Node>)
+    {
+        hasher.mix(node.hash);
+    }
+    else if constexpr (is_seq_node<Node>)
+    {
+        std::apply([&](auto const&... elements) { (mix_subtree(hasher, elements), ...); }, node.node_sequence);
+    }
+    else if constexpr (is_alt_node<Node>)
+    {
+        hasher.mix(node.index());
+        std::visit([&](auto const& alternative) { mix_subtree(hasher, alternative); }, node.node_alternatives);
+    }
+    else if constexpr (is_rep_node<Node>)
+    {
+        hasher.mix(node.size());
+        for (auto const& element : node.node_repetitions)
+            mix_subtree(hasher, element);
+    }
+    else if constexpr (is_operator_node<Node>)
+    {
+        hasher.mix(node.node_operands.size());
+        for (auto const& operand : node.node_operands)
+            mix_subtree(hasher, operand);
+        for (auto const& operation : node.node_operations)
+        {
+            hasher.mix(operation.op);
+            hasher.mix(operation.lhs.index * 2 + operation.lhs.operation);
+            hasher.mix(operation.rhs.index * 2 + operation.rhs.operation);
+        }
+    }
+    else if constexpr (is_inbuilt_node<Node>)
+    {
+        hasher.mix_bytes(as_chars(node.source_text));
+    }
+}
 
 template<typename Parser, nonterminal_expr Expr>
-constexpr auto parse_nonterminal(std::string_view input) -> parse_tree_node<Parser, Expr>
+struct builder<Parser, Expr>
 {
-    static constexpr auto        symbol           = Expr.symbol;
-    static constexpr auto        grammar          = Parser::s_grammar;
-    static constexpr auto        production_count = grammar.production_count();
-    static constexpr std::size_t index            = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    using traits = grammar_traits<Parser>;
+
+    static constexpr std::size_t index = traits::template production_index<Expr.symbol>;
+
+    static constexpr void build(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                std::span<std::size_t const>&  decisions)
     {
-        std::size_t i = 0;
-        ((i = is, structural::get<is>(grammar.productions).symbol == symbol) || ...) || (i = production_count);
-        return i;
-    }(std::make_index_sequence<production_count>{});
-    static_assert(index < production_count, "Unknown symbol!");
+        if constexpr (parse_tree_node<Parser, Expr>::captured)
+            build_nested(node, input, decisions);
+        else
+            build_span(node, input, decisions);
+    }
 
-    static constexpr auto expression = structural::get<index>(grammar.productions).expression;
+  private:
+    // Builds the node of a production that isn't captured, for which only the length of the match was recorded
+    static constexpr void build_span(parse_tree_node<Parser, Expr>& node,
+                                     std::string_view const         input,
+                                     std::span<std::size_t const>&  decisions)
+    {
+        node.valid       = true;
+        node.source_text = from_chars<text_t<Parser>>(input.substr(0, pop_decision(decisions)));
+        if constexpr (traits::hashes_subtrees)
+        {
+            subtree_hasher hasher;
+            hasher.mix(index);
+            hasher.mix_bytes(as_chars(node.source_text));
+            node.hash = hasher.finish();
+        }
+    }
+
+    static constexpr void build_nested(parse_tree_node<Parser, Expr>& node,
+                                       std::string_view const         input,
+                                       std::span<std::size_t const>&  decisions)
+    {
+        static constexpr auto expression = traits::template expression<Expr.symbol>;
 
-    static constexpr auto nt_parser = detail::parser_creator<Parser, expression>()();
+        if constexpr (!traits::sync_points[index].empty())
+        {
+            // The nested node is kept for reuse if the production recovered
+            if (std::size_t const skipped = pop_decision(decisions); skipped != 0)
+            {
+                node.valid       = false;
+                node.recovered   = true;
+                node.source_text = from_chars<text_t<Parser>>(input.substr(0, skipped));
+                if constexpr (traits::hashes_subtrees)
+                {
+                    // Error nodes are hashed like productions of their own, matching the skipped input
+                    subtree_hasher hasher;
+                    hasher.mix(traits::production_count + index);
+                    hasher.mix_bytes(input.substr(0, skipped));
+                    node.hash = hasher.finish();
+                }
+                return;
+            }
+        }
 
-    auto result = nt_parser(input);
-    return parse_tree_node<Parser, nonterminal_expr{symbol}>{
-        .valid       = result.valid,
-        .source_text = result.source_text,
-        .nested      = indirect(std::move(result)),
-    };
-}
+        if constexpr (std::is_const_v<std::remove_reference_t<decltype(*node.nested)>>)
+        {
+            // Shared nested nodes are immutable, so they can't be reused
+            parse_tree_node<Parser, expression> nested;
+            builder<Parser, expression>::build(nested, input, decisions);
+            node.nested = std::move(nested);
+        }
+        else
+        {
+            if (!node.nested)
+                node.nested = parse_tree_node<Parser, expression>{};
+            builder<Parser, expression>::build(*node.nested, input, decisions);
+        }
+        node.valid       = true;
+        node.recovered   = false;
+        node.source_text = node.nested->source_text;
+        if constexpr (traits::hashes_subtrees)
+        {
+            subtree_hasher hasher;
+            hasher.mix(index);
+            mix_subtree(hasher, *node.nested);
+            node.hash = hasher.finish();
+        }
+    }
+};
 
 template<typename Parser, terminal_expr Expr>
-constexpr auto parse_terminal(std::string_view input) -> parse_tree_node<Parser, Expr>
+struct builder<Parser, Expr>
 {
-    if (input.starts_with(Expr.terminal))
+    static constexpr void build(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                std::span<std::size_t const>& /*decisions*/)
     {
-        return parse_tree_node<Parser, Expr>{
-            .valid       = true,
-            .source_text = input.substr(0, Expr.terminal.size()),
-        };
+        node.valid       = true;
+        node.source_text = from_chars<text_t<Parser>>(input.substr(0, Expr.terminal.size()));
     }
-    return parse_tree_node<Parser, Expr>{};
-}
+};
 
 template<typename Parser, seq_expr Expr>
-constexpr auto parse_seq(std::string_view input) -> parse_tree_node<Parser, Expr>
+struct builder<Parser, Expr>
 {
-    static constexpr auto sub_parsers = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    static constexpr void build(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                std::span<std::size_t const>&  decisions)
     {
-        return structural::tuple{parser_creator<Parser, structural::get<is>(Expr.sequence)>()()...};
-    }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.sequence)>>{});
+        std::size_t length = 0;
+        [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        {
+            ((builder<Parser, structural::get<is>(Expr.sequence)>::build(std::get<is>(node.node_sequence),
+                                                                         input.substr(length),
+                                                                         decisions),
+              length += std::get<is>(node.node_sequence).source_text.size()),
+             ...);
+        }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.sequence)>>{});
+        node.valid       = true;
+        node.source_text = from_chars<text_t<Parser>>(input.substr(0, length));
+    }
+};
 
-    static constexpr auto parse_one = []<std::size_t I>(std::string_view& input, bool& valid, std::size_t& consumed)
+template<typename Parser, alt_expr Expr>
+struct builder<Parser, Expr>
+{
+    template<std::size_t I>
+    static constexpr void build_alternative(parse_tree_node<Parser, Expr>& node,
+                                            std::string_view const         input,
+                                            std::span<std::size_t const>&  decisions)
     {
-        if (!valid) // Short-circuit
-            return parse_tree_node<Parser, get<I>(Expr.sequence)>{};
+        if (node.node_alternatives.index() != I)
+            node.node_alternatives.template emplace<I>();
+        auto& alternative = std::get<I>(node.node_alternatives);
+        builder<Parser, structural::get<I>(Expr.alternatives)>::build(alternative, input, decisions);
+        node.valid       = true;
+        node.source_text = alternative.source_text;
+    }
 
-        auto r = structural::get<I>(sub_parsers)(input);
-        input.remove_prefix(r.source_text.size());
-        valid &= r.valid;
-        consumed += r.source_text.size();
-        return r;
-    };
-    return [remaining_input = input, &input]<std::size_t... is>(std::index_sequence<is...>) constexpr mutable
+    static constexpr void build(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                std::span<std::size_t const>&  decisions)
     {
-        bool        valid    = true;
-        std::size_t consumed = 0;
-        std::tuple  results { parse_one.template operator()<is>(remaining_input, valid, consumed)... };
-        return parse_tree_node<Parser, Expr>{.valid         = valid,
-                                             .source_text   = input.substr(0, consumed),
-                                             .node_sequence = std::move(results)};
-    }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.sequence)>>{});
-}
+        std::size_t const chosen = pop_decision(decisions);
+        [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        {
+            ((chosen == is && (build_alternative<is>(node, input, decisions), true)) || ...);
+        }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.alternatives)>>{});
+    }
+};
 
-template<typename Parser, alt_expr Expr>
-constexpr auto parse_alt(std::string_view input) -> parse_tree_node<Parser, Expr>
+template<typename Parser, rep_expr Expr>
+struct builder<Parser, Expr>
 {
-    static constexpr auto sub_parsers = []<std::size_t... is>(std::index_sequence<is...>) constexpr
+    static constexpr void build(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                std::span<std::size_t const>&  decisions)
     {
-        return structural::tuple{parser_creator<Parser, structural::get<is>(Expr.alternatives)>()()...};
-    }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.alternatives)>>{});
+        auto& elements = node.node_repetitions;
+        elements.resize(pop_decision(decisions));
 
-    constexpr auto create_rettype = []<std::size_t... is>(std::index_sequence<is...>) constexpr
-    {
-        using T = std::variant<std::invoke_result_t<decltype(get<is>(sub_parsers)), std::string_view>...>;
-        return T();
-    };
-    using return_type = decltype(create_rettype(
-        std::make_index_sequence<std::tuple_size_v<decltype(Expr.alternatives)>>{}));
+        std::size_t length = 0;
+        for (auto& element : elements)
+        {
+            builder<Parser, Expr.element>::build(element, input.substr(length), decisions);
+            length += element.source_text.size();
+        }
+
+        node.valid       = true;
+        node.source_text = from_chars<text_t<Parser>>(input.substr(0, length));
+    }
+};
 
-    return [input]<std::size_t... is>(std::index_sequence<is...>)
+template<typename Parser, operator_expr Expr>
+struct builder<Parser, Expr>
+{
+    static constexpr void build(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                std::span<std::size_t const>&  decisions)
     {
-        return_type result;
-        ((result = get<is>(sub_parsers)(input), std::visit([](auto const& r) { return r.valid; }, result)) || ...);
+        using table = operator_table<Expr>;
+
+        auto& operands = node.node_operands;
+        operands.resize(pop_decision(decisions) + 1);
+
+        std::size_t length = 0;
+        for (std::size_t i = 0; i < operands.size(); ++i)
+        {
+            if (i != 0)
+                length += table::entries[pop_decision(decisions)].symbol.size();
+            builder<Parser, Expr.operand>::build(operands[i], input.substr(length), decisions);
+            length += operands[i].source_text.size();
+        }
+
+        // The operators and spans are read back from the operands, so ordering them doesn't allocate
+        auto const span = [&](std::size_t const i)
+        {
+            auto const begin = static_cast<std::size_t>(as_chars(operands[i].source_text).data() - input.data());
+            return source_span{.begin = begin, .end = begin + operands[i].source_text.size()};
+        };
+        auto const op = [&](std::size_t const i) { return table::match(input.substr(span(i).end)); };
+        build_operations<Expr>(operands.size() - 1, op, span, input, node.node_operations);
 
-        bool             valid       = std::visit([](auto const& r) { return r.valid; }, result);
-        std::string_view source_text = std::visit([](auto const& r) { return r.source_text; }, result);
+        node.valid       = true;
+        node.source_text = from_chars<text_t<Parser>>(input.substr(0, length));
+    }
+};
 
-        return parse_tree_node<Parser, Expr>{.valid             = valid,
-                                             .source_text       = source_text,
-                                             .node_alternatives = std::move(result)};
-    }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.alternatives)>>{});
+template<typename Parser, inbuilt_expr Expr>
+struct builder<Parser, Expr>
+{
+    static constexpr void build(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                std::span<std::size_t const>& /*decisions*/)
+    {
+        node.valid       = true;
+        node.source_text = from_chars<text_t<Parser>>(input.substr(0, recognize<Parser, Expr>(input).length));
+    }
+};
+
+// Marks node as failed after consuming the first length chars of input
+template<typename Parser, auto Expr>
+constexpr void build_failure(parse_tree_node<Parser, Expr>& node,
+                             std::string_view const         input,
+                             std::size_t const              length)
+{
+    node.valid       = false;
+    node.source_text = from_chars<text_t<Parser>>(input.substr(0, length));
 }
 
-template<typename Parser, rep_expr Expr>
-constexpr auto parse_rep(std::string_view input) -> parse_tree_node<Parser, Expr>
+// Builds the parse tree of input into node from the decisions recorded in log while recognizing it
+//
+// Input is recognized once, recording its decisions as it goes. If it didn't match, nothing is built and the decisions
+// recorded before failing are discarded, so failing only costs the storage of log, which is reused between parses.
+template<typename Parser, auto Expr>
+constexpr void build_recognized(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                decision_log&                  log,
+                                match_result const             recognized)
 {
-    static constexpr auto sub_parser = parser_creator<Parser, Expr.element>()();
+    if (!recognized)
+    {
+        log.clear();
+        build_failure(node, input, recognized.length);
+        return;
+    }
 
-    auto const  orig_input = input;
-    std::size_t consumed   = 0;
+    std::span<std::size_t const> decisions = log.decisions();
+    builder<Parser, Expr>::build(node, input, decisions);
+}
 
-    std::vector<parse_tree_node<Parser, Expr.element>> parsed;
+// Parses input, which is known to be valid UTF-8 if the grammar matches codepoints, into an existing parse tree
+//
+// See parse_into. If the parser scans the structure of its input, the input is indexed into structure first and the
+// recognizer looks up strings in the index.
+template<typename Parser, auto Expr>
+constexpr void parse_valid_into(parse_tree_node<Parser, Expr>& node,
+                                std::string_view const         input,
+                                decision_log&                  log,
+                                structural_index&              structure)
+{
+    log.clear();
+    if constexpr (grammar_traits<Parser>::scans_structure)
+    {
+        structure.reset(input);
+        indexed_log recording{log, structure, input};
+        build_recognized(node, input, log, recognizer<Parser, Expr>::match(input, recording));
+    }
+    else
+    {
+        build_recognized(node, input, log, recognizer<Parser, Expr>::match(input, log));
+    }
+}
 
-    for (auto r = sub_parser(input); r; r = sub_parser(input))
+// Checks whether input is valid UTF-8 if the grammar matches codepoints; otherwise, node fails with the valid prefix
+template<typename Parser, auto Expr>
+constexpr auto validate_encoding(parse_tree_node<Parser, Expr>& node, std::string_view const input) -> bool
+{
+    if constexpr (requires { Expr.symbol; }) // Grammar traits are only available when starting at a production
     {
-        parsed.push_back(r);
-        consumed += r.source_text.size();
-        input.remove_prefix(r.source_text.size());
+        if constexpr (grammar_traits<Parser>::matches_codepoints)
+        {
+            if (std::size_t const valid = valid_utf8_prefix(input); valid != input.size())
+            {
+                build_failure(node, input, valid);
+                return false;
+            }
+        }
     }
+    return true;
+}
 
-    return parse_tree_node<Parser, Expr>{
-        .valid            = true,
-        .source_text      = orig_input.substr(0, consumed),
-        .node_repetitions = std::move(parsed),
-    };
+// Parses input into an existing parse tree, reusing its storage and that of log and structure
+//
+// Input is recognized before anything is built, so failing never allocates nodes. If parsing fails, only the validity
+// and consumed source text of node are updated; its nested nodes are left in an unspecified state. If the grammar
+// matches codepoints, input is validated first, and invalid UTF-8 fails with the valid prefix as consumed source text.
+// Input skipped to recover from failures is left in log.
+template<typename Parser, auto Expr>
+constexpr void parse_into(parse_tree_node<Parser, Expr>& node,
+                          std::string_view const         input,
+                          decision_log&                  log,
+                          structural_index&              structure)
+{
+    if (validate_encoding(node, input))
+        parse_valid_into(node, input, log, structure);
+    else
+        log.clear();
 }
 
-template<typename Parser, inbuilt_expr Expr>
-constexpr auto parse_inbuilt(std::string_view input) -> parse_tree_node<Parser, Expr>
+// Parses input into a new parse tree
+//
+// If parsing fails, only the validity and consumed source text of the result are set, and nothing is allocated. Unlike
+// parse contexts, there is no decision log whose storage could be reused, so input is recognized without recording
+// decisions first, and only recognized again into a new log once it is known to match. This matches valid input twice,
+// which is cheaper than the allocations that recording would cost failing input.
+template<typename Parser, auto Expr>
+constexpr auto parse_expression(std::string_view const input) -> parse_tree_node<Parser, Expr>
 {
-    if constexpr (std::is_invocable_r_v<bool, decltype(Expr.parse), char>)
+    parse_tree_node<Parser, Expr> node;
+    if (!validate_encoding(node, input))
+        return node;
+
+    if (match_result const recognized = recognize<Parser, Expr>(input); !recognized)
     {
-        if (input.empty() || !Expr.parse(input.front()))
-            return parse_tree_node<Parser, Expr>{};
-        return parse_tree_node<Parser, Expr>{.valid = true, .source_text = input.substr(0, 1)};
+        build_failure(node, input, recognized.length);
+        return node;
     }
-    else if constexpr (std::is_invocable_r_v<std::optional<std::size_t>, decltype(Expr.parse), std::string_view>)
+
+    decision_log     log;
+    structural_index structure;
+    parse_valid_into(node, input, log, structure);
+    return node;
+}
+
+// Parses input into a new parse tree, unless it exceeds the given budget
+//
+// The budget is enforced while recognizing input without recording decisions, before anything is allocated. Like
+// without a budget, input is only recorded and built once it is known to match, which then takes as many steps
+// again, and the parse tree has at most as many symbol nodes as productions were matched.
+template<typename Parser, auto Expr>
+constexpr auto parse_expression(std::string_view const input, parse_budget const budget)
+    -> std::expected<parse_tree_node<Parser, Expr>, budget_exceeded>
+{
+    parse_tree_node<Parser, Expr> node;
+    if (!validate_encoding(node, input))
+        return node;
+
+    null_log           discarded;
+    budget_log         counter{discarded, budget, input};
+    match_result const recognized = recognizer<Parser, Expr>::match(input, counter);
+    if (counter.exhausted())
+        return std::unexpected(*counter.exceeded());
+    if (!recognized)
     {
-        auto const result = Expr.parse(input);
-        if (!result)
-            return parse_tree_node<Parser, Expr>{};
-        return parse_tree_node<Parser, Expr>{.valid = true, .source_text = input.substr(0, result.value())};
+        build_failure(node, input, recognized.length);
+        return node;
     }
+
+    decision_log     log;
+    structural_index structure;
+    parse_valid_into(node, input, log, structure);
+    return node;
+}
+
+template<typename Parser, nonterminal_expr Expr>
+constexpr auto parse_nonterminal(std::string_view input) -> parse_tree_node<Parser, Expr>
+{
+    return parse_expression<Parser, Expr>(input);
 }
 
 // Note: it's important that the parser_creators below don't return a lambda expression since gcc fails to
 // constant-evaluate it ("dereferencing null pointer"), possibly due to
 // https://gcc.gnu.org/bugzilla/show_bug.cgi?id=115878.
 
-#define ELVIS_PARSELY_MAKE_PARSER_CREATOR(EXPR)                                                                        \
-    template<typename Parser, detail::EXPR##_expr Expr>                                                                \
-    struct parser_creator<Parser, Expr>                                                                                \
-    {                                                                                                                  \
-        static consteval auto operator()() -> parse_tree_node<Parser, Expr> (*)(std::string_view)                      \
-        {                                                                                                              \
-            return &parse_##EXPR<Parser, Expr>;                                                                        \
-        }                                                                                                              \
-    };
-
-ELVIS_PARSELY_MAKE_PARSER_CREATOR(nonterminal)
-ELVIS_PARSELY_MAKE_PARSER_CREATOR(terminal)
-ELVIS_PARSELY_MAKE_PARSER_CREATOR(seq)
-ELVIS_PARSELY_MAKE_PARSER_CREATOR(alt)
-ELVIS_PARSELY_MAKE_PARSER_CREATOR(rep)
-ELVIS_PARSELY_MAKE_PARSER_CREATOR(inbuilt)
-
-#undef ELVIS_PARSELY_MAKE_PARSER_CREATOR
+template<typename Parser, auto Expr>
+struct parser_creator
+{
+    static consteval auto operator()() -> parse_tree_node<Parser, Expr> (*)(std::string_view)
+    {
+        return &parse_expression<Parser, Expr>;
+    }
+};
 } // namespace parsely::detail
 
 #endif // INCLUDE_PARSELY_UTILITY_PARSER_CREATOR_HPP
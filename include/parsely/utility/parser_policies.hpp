@@ -0,0 +1,226 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_PARSER_POLICIES_HPP
+#define INCLUDE_PARSELY_UTILITY_PARSER_POLICIES_HPP
+
+#include <parsely/utility/indirect.hpp>
+#include <parsely/utility/shared_indirect.hpp>
+#include <parsely/utility/text.hpp>
+
+#include <structural/inplace_string.hpp>
+
+#include <string_view>
+#include <type_traits>
+
+namespace parsely
+{
+// Parser policy: Stores the nested nodes of nonterminal parse tree nodes in immutable, reference-counted storage, so
+// parse trees can be copied in O(1). If ThreadSafe is true, copies may be shared between threads.
+template<bool ThreadSafe = false>
+struct shared_tree
+{
+};
+
+// Parser policy: Accepts input of type Text, which is also the type of the source text in parse trees
+//
+// Text may be std::string_view (the default), std::u8string_view or std::span<std::byte const>.
+template<input_text Text>
+struct input
+{
+};
+
+// Parser policy: Fails to compile if any production of the grammar needs backtracking, listing those productions
+//
+// A production needs backtracking if one of its alternative expressions can't be chosen by looking at the next char of
+// the input alone.
+struct require_predictive
+{
+};
+
+// Parser policy: Recovers from failures of the production Symbol by skipping the input up to and including the next
+// occurrence of Sync (or to the end of the input)
+//
+// The skipped input becomes an error node: an invalid node of Symbol whose recovered flag is set and whose source text
+// is the skipped input. Parsing continues after it as if Symbol had matched, so e.g. recover<"record", "\n"> turns each
+// malformed line of a record-per-line file into an error node. Only non-empty input is skipped. Semantic actions and
+// recognize() don't recover.
+template<structural::inplace_string Symbol, structural::inplace_string Sync>
+struct recover
+{
+    static_assert(!std::string_view{Sync}.empty(), "The synchronization point must not be empty!");
+};
+
+// Parser policy: Indexes the quotes of the input before parsing it (see structural_index), so that $string expressions
+// are matched by looking up their closing quote instead of scanning their contents
+//
+// Every quote of the input that isn't escaped by a backslash must delimit a $string, as in JSON. Building the index
+// takes a single vectorized pass over the input, which pays off for inputs dominated by strings, since backtracking no
+// longer scans the strings again.
+struct structural_scan
+{
+};
+
+// Parser policy: Computes the hash of each subtree while parsing, stored in the hash member of symbol nodes
+//
+// The hash of a node combines the id of its production with the hashes of its child nonterminals and the source text of
+// its other leaves, so equal subtrees have equal hashes wherever they occur. Comparing hashes tests subtrees for
+// equality in constant time (up to hash collisions), and hashes can key caches of results computed from subtrees.
+// Comparing nodes with == compares their hashes first, so unequal subtrees are usually told apart immediately.
+struct hashed_tree
+{
+};
+
+// Parser policy: Only builds the nodes of the productions named Symbols and of the productions leading to them
+//
+// The nodes of all other productions become span nodes: symbol nodes that keep their source text but have no nested
+// node, since their productions are matched like by recognize() and only their lengths are recorded. This saves the
+// nodes and allocations of char-level productions such as digits or identifier chars. Productions that recover from
+// failures are always built, so error nodes are kept. Mapping doesn't support capturing.
+template<structural::inplace_string... Symbols>
+struct capture
+{
+};
+
+namespace detail
+{
+template<typename Policy, typename... Policies>
+inline constexpr bool has_policy = (std::is_same_v<Policy, Policies> || ...);
+
+template<typename T, typename... Policies>
+struct select_nested_storage
+{
+    using type = indirect<T>;
+};
+
+template<typename T, bool ThreadSafe, typename... Policies>
+struct select_nested_storage<T, shared_tree<ThreadSafe>, Policies...>
+{
+    using type = shared_indirect<T, ThreadSafe>;
+};
+
+template<typename T, typename Policy, typename... Policies>
+struct select_nested_storage<T, Policy, Policies...> : select_nested_storage<T, Policies...>
+{
+};
+
+// The storage used by nonterminal parse tree nodes of Parser to hold their nested node of type T
+template<typename Parser, typename T>
+struct nested_storage
+{
+    using type = indirect<T>;
+};
+
+template<typename Parser, typename T>
+    requires requires { typename Parser::template nested_storage<T>; }
+struct nested_storage<Parser, T>
+{
+    using type = typename Parser::template nested_storage<T>;
+};
+
+template<typename Parser, typename T>
+using nested_storage_t = typename nested_storage<Parser, T>::type;
+
+// Stands in for the nested node of the symbol nodes of productions that aren't captured (see capture)
+struct span_node
+{
+    constexpr auto operator==(span_node const&) const -> bool = default;
+};
+
+template<typename Policy>
+struct recovery_policy
+{
+    static constexpr auto sync_point(std::string_view /*symbol*/) -> std::string_view { return {}; }
+};
+
+template<structural::inplace_string Symbol, structural::inplace_string Sync>
+struct recovery_policy<recover<Symbol, Sync>>
+{
+    static constexpr auto sync_point(std::string_view const symbol) -> std::string_view
+    {
+        return symbol == std::string_view{Symbol} ? std::string_view{Sync} : std::string_view{};
+    }
+};
+
+// The text at which failures of the production named symbol are recovered from, or an empty string if they aren't
+template<typename... Policies>
+constexpr auto select_sync_point(std::string_view const symbol) -> std::string_view
+{
+    std::string_view result;
+    ((result = result.empty() ? recovery_policy<Policies>::sync_point(symbol) : result), ...);
+    return result;
+}
+
+template<typename Policy>
+struct capture_policy
+{
+    static constexpr bool restricts = false;
+
+    static constexpr auto captures(std::string_view /*symbol*/) -> bool { return false; }
+
+    static constexpr auto all_symbols(auto /*predicate*/) -> bool { return true; }
+};
+
+template<structural::inplace_string... Symbols>
+struct capture_policy<capture<Symbols...>>
+{
+    static constexpr bool restricts = true;
+
+    static constexpr auto captures(std::string_view const symbol) -> bool
+    {
+        return ((symbol == std::string_view{Symbols}) || ...);
+    }
+
+    // True if predicate holds for all captured symbols
+    static constexpr auto all_symbols(auto const predicate) -> bool
+    {
+        return (predicate(std::string_view{Symbols}) && ...);
+    }
+};
+
+// True if the productions named symbol are captured: if no policy restricts captures, or one of them captures symbol
+template<typename... Policies>
+constexpr auto select_captured(std::string_view const symbol) -> bool
+{
+    return !(capture_policy<Policies>::restricts || ...) || (capture_policy<Policies>::captures(symbol) || ...);
+}
+
+template<typename... Policies>
+struct select_text
+{
+    using type = std::string_view;
+};
+
+template<typename Text, typename... Policies>
+struct select_text<input<Text>, Policies...>
+{
+    using type = Text;
+};
+
+template<typename Policy, typename... Policies>
+struct select_text<Policy, Policies...> : select_text<Policies...>
+{
+};
+
+// The type of input accepted by Parser and of the source text in its parse trees
+template<typename Parser>
+struct text
+{
+    using type = std::string_view;
+};
+
+template<typename Parser>
+    requires requires { typename Parser::text_type; }
+struct text<Parser>
+{
+    using type = typename Parser::text_type;
+};
+
+template<typename Parser>
+using text_t = typename text<Parser>::type;
+} // namespace detail
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_PARSER_POLICIES_HPP
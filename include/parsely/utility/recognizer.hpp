@@ -0,0 +1,419 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_RECOGNIZER_HPP
+#define INCLUDE_PARSELY_UTILITY_RECOGNIZER_HPP
+
+#include <parsely/utility/grammar_analysis.hpp>
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
+#include <parsely/utility/operator_table.hpp>
+
+#include <structural/inplace_string.hpp>
+#include <structural/tuple.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace parsely::detail
+{
+// The result of recognizing an input string
+struct match_result
+{
+    bool        valid  = false; // True if the input matched
+    std::size_t length = 0;     // Length of the matched prefix, or of the prefix consumed before failing
+
+    constexpr explicit operator bool() const { return valid; };
+};
+
+// Records the decisions taken while recognizing an input string, so that its parse tree can be built without matching
+// it again
+//
+// One decision is recorded per matched alternative expression (the index of the matching alternative), per matched
+// repetition expression (the number of elements), per matched operator table (the number of operators) and per
+// operator (its index), and per matched nonterminal whose production recovers from failures (the number of chars
+// skipped, or 0 if it didn't fail), in the order in which the expressions start. The skipped input of recovered
+// nonterminals is recorded as well. Nonterminals whose decisions aren't recorded (see records_decisions) record their
+// length in place of the decisions of their expressions.
+class decision_log
+{
+  public:
+    [[nodiscard]] constexpr auto mark() const -> std::size_t { return m_decisions.size(); }
+    constexpr void               push(std::size_t const decision) { m_decisions.push_back(decision); }
+    constexpr void               set(std::size_t const at, std::size_t const decision) { m_decisions[at] = decision; }
+
+    constexpr void truncate(std::size_t const at)
+    {
+        m_decisions.resize(at);
+        while (!m_recoveries.empty() && m_recoveries.back().decision >= at)
+            m_recoveries.pop_back();
+    }
+
+    constexpr void clear()
+    {
+        m_decisions.clear();
+        m_recoveries.clear();
+    }
+
+    // Records that the decision at index at skipped the given input to recover from a failure
+    constexpr void recover(std::size_t const at, std::string_view const skipped)
+    {
+        m_recoveries.push_back(recovery{.decision = at, .skipped = skipped});
+    }
+
+    [[nodiscard]] constexpr auto decisions() const -> std::span<std::size_t const> { return m_decisions; }
+
+    // Returns the input skipped by each recovery, in input order
+    [[nodiscard]] constexpr auto recoveries() const
+    {
+        return m_recoveries | std::views::transform(&recovery::skipped);
+    }
+
+  private:
+    struct recovery
+    {
+        std::size_t      decision;
+        std::string_view skipped;
+    };
+
+    std::vector<std::size_t> m_decisions;
+    std::vector<recovery>    m_recoveries;
+};
+
+// A decision log that discards all decisions
+struct null_log
+{
+    [[nodiscard]] static constexpr auto mark() -> std::size_t { return 0; }
+    static constexpr void               push(std::size_t /*decision*/) {}
+    static constexpr void               set(std::size_t /*at*/, std::size_t /*decision*/) {}
+    static constexpr void               truncate(std::size_t /*at*/) {}
+    static constexpr void               recover(std::size_t /*at*/, std::string_view /*skipped*/) {}
+};
+
+// Checks whether the decisions of the production named Symbol are recorded into Log, or only its length
+//
+// By default, the decisions of captured productions are recorded (see capture). Logs may choose the productions
+// themselves by providing `records<Symbol>`.
+template<typename Parser, typename Log, structural::inplace_string Symbol>
+consteval auto records_decisions() -> bool
+{
+    if constexpr (requires { Log::template records<Symbol>; })
+        return Log::template records<Symbol>;
+    else
+        return grammar_traits<Parser>::captured[grammar_traits<Parser>::template production_index<Symbol>];
+}
+
+// Checks whether log enforces a budget that has been exceeded (see budget_log)
+template<typename Log>
+constexpr auto exhausted(Log const& log) -> bool
+{
+    if constexpr (requires { log.exhausted(); })
+        return log.exhausted();
+    else
+        return false;
+}
+
+// Matches input against a grammar expression without building a parse tree
+//
+// Recognizing never allocates, unless decisions are recorded in a decision_log. Repetitions stop at the first element
+// that matches the empty string. If matching fails, the decisions recorded so far are left in the log and have to be
+// discarded by the caller.
+template<typename Parser, auto Expr>
+struct recognizer;
+
+// If the production recovers from failures and fails on non-empty input, the input up to and including its sync point
+// is skipped instead. Logs that enforce a budget are notified before and after matching the production.
+template<typename Parser, nonterminal_expr Expr>
+struct recognizer<Parser, Expr>
+{
+    template<typename Log>
+    static constexpr auto match(std::string_view const input, Log& log) -> match_result
+    {
+        if constexpr (requires { log.enter(input); })
+        {
+            if (!log.enter(input))
+                return match_result{};
+            match_result const result = match_production(input, log);
+            log.leave(input, result.valid);
+            return result;
+        }
+        else
+        {
+            return match_production(input, log);
+        }
+    }
+
+  private:
+    template<typename Log>
+    static constexpr auto match_production(std::string_view const input, Log& log) -> match_result
+    {
+        using traits = grammar_traits<Parser>;
+        constexpr std::size_t index = traits::template production_index<Expr.symbol>;
+        static_assert(index < traits::production_count, "Unknown symbol!");
+
+        using expression = recognizer<Parser, traits::template expression<Expr.symbol>>;
+        if constexpr (!records_decisions<Parser, Log, Expr.symbol>())
+        {
+            // The node is built from the length of the match alone, so the decisions of the expression are dropped
+            std::size_t const  decision = log.mark();
+            match_result const result   = expression::match(input, log);
+            if (result)
+            {
+                log.truncate(decision);
+                log.push(result.length);
+            }
+            return result;
+        }
+        else if constexpr (traits::sync_points[index].empty())
+        {
+            return expression::match(input, log);
+        }
+        else
+        {
+            std::size_t const decision = log.mark();
+            log.push(0);
+            match_result const result = expression::match(input, log);
+            if (result || input.empty() || exhausted(log))
+                return result;
+
+            log.truncate(decision + 1);
+            std::string_view const sync   = traits::sync_points[index];
+            std::size_t const      at     = input.find(sync);
+            std::size_t const      length = at == std::string_view::npos ? input.size() : at + sync.size();
+            log.set(decision, length);
+            log.recover(decision, input.substr(0, length));
+            return match_result{.valid = true, .length = length};
+        }
+    }
+};
+
+template<typename Parser, terminal_expr Expr>
+struct recognizer<Parser, Expr>
+{
+    template<typename Log>
+    static constexpr auto match(std::string_view const input, Log& /*log*/) -> match_result
+    {
+        if (input.starts_with(Expr.terminal))
+            return match_result{.valid = true, .length = Expr.terminal.size()};
+        return match_result{};
+    }
+};
+
+template<typename Parser, seq_expr Expr>
+struct recognizer<Parser, Expr>
+{
+    template<typename Log>
+    static constexpr auto match(std::string_view const input, Log& log) -> match_result
+    {
+        std::size_t length = 0;
+        bool const  valid  = [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        {
+            return ([&]
+                    {
+                        auto const r = recognizer<Parser, structural::get<is>(Expr.sequence)>::match(
+                            input.substr(length),
+                            log);
+                        length += r.length;
+                        return r.valid;
+                    }()
+                    && ...);
+        }(std::make_index_sequence<std::tuple_size_v<decltype(Expr.sequence)>>{});
+        return match_result{.valid = valid, .length = length};
+    }
+};
+
+template<typename Parser, alt_expr Expr>
+struct recognizer<Parser, Expr>
+{
+    using prediction = detail::prediction<Parser, Expr>;
+
+    static constexpr std::size_t size = prediction::size;
+
+    // Matches the alternative with the given index, or fails if there is none
+    template<typename Log>
+    static constexpr auto match_alternative(std::size_t const index, std::string_view const input, Log& log)
+        -> match_result
+    {
+        match_result result;
+        [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+        {
+            ((index == is
+              && (result = recognizer<Parser, structural::get<is>(Expr.alternatives)>::match(input, log), true))
+             || ...);
+        }(std::make_index_sequence<size>{});
+        return result;
+    }
+
+    // Alternatives that can't match the next char are skipped, since they fail without consuming input. If the
+    // expression is predictive, the only alternative that may match is looked up instead of trying them in order.
+    template<typename Log>
+    static constexpr auto match(std::string_view const input, Log& log) -> match_result
+    {
+        std::size_t const lookahead = prediction::lookahead(input);
+        std::size_t const decision  = log.mark();
+        log.push(0);
+
+        match_result result;
+        if constexpr (prediction::predictive)
+        {
+            std::size_t chosen = prediction::table[lookahead];
+            result             = match_alternative(chosen, input, log);
+            if (!result && prediction::fallback[chosen] < size)
+            {
+                log.truncate(decision + 1);
+                chosen = prediction::fallback[chosen];
+                result = match_alternative(chosen, input, log);
+            }
+
+            if (result)
+                log.set(decision, chosen);
+            else if (chosen + 1 < size) // The alternatives after the chosen one fail without consuming input
+                result.length = 0;
+        }
+        else
+        {
+            [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+            {
+                ([&]
+                 {
+                     if (!prediction::is_candidate(is, lookahead) || exhausted(log))
+                     {
+                         result = match_result{};
+                         return false;
+                     }
+                     log.truncate(decision + 1);
+                     result = recognizer<Parser, structural::get<is>(Expr.alternatives)>::match(input, log);
+                     if (result)
+                         log.set(decision, is);
+                     return result.valid;
+                 }()
+                 || ...);
+            }(std::make_index_sequence<size>{});
+        }
+
+        if (!result)
+            log.truncate(decision);
+        return result;
+    }
+};
+
+template<typename Parser, rep_expr Expr>
+struct recognizer<Parser, Expr>
+{
+    template<typename Log>
+    static constexpr auto match(std::string_view const input, Log& log) -> match_result
+    {
+        using element = recognizer<Parser, Expr.element>;
+
+        std::size_t const decision = log.mark();
+        log.push(0);
+
+        std::size_t count  = 0;
+        std::size_t length = 0;
+        while (true)
+        {
+            std::size_t const mark = log.mark();
+            auto const        r    = element::match(input.substr(length), log);
+            if (!r || r.length == 0)
+            {
+                log.truncate(mark);
+                break;
+            }
+            length += r.length;
+            ++count;
+        }
+        log.set(decision, count);
+        return match_result{.valid = true, .length = length};
+    }
+};
+
+// Operators are matched longest first. If the operand after an operator fails, the match ends before the operator.
+template<typename Parser, operator_expr Expr>
+struct recognizer<Parser, Expr>
+{
+    template<typename Log>
+    static constexpr auto match(std::string_view const input, Log& log) -> match_result
+    {
+        using table   = operator_table<Expr>;
+        using operand = recognizer<Parser, Expr.operand>;
+
+        std::size_t const decision = log.mark();
+        log.push(0);
+
+        match_result result = operand::match(input, log);
+        if (!result)
+            return result;
+
+        std::size_t count = 0;
+        while (true)
+        {
+            std::string_view const rest = input.substr(result.length);
+            std::size_t const      op   = table::match(rest);
+            if (op == table::size)
+                break;
+
+            std::size_t const mark = log.mark();
+            log.push(op);
+            std::size_t const op_length = table::entries[op].symbol.size();
+            auto const        r         = operand::match(rest.substr(op_length), log);
+            if (!r)
+            {
+                log.truncate(mark);
+                break;
+            }
+            result.length += op_length + r.length;
+            ++count;
+        }
+        log.set(decision, count);
+        return result;
+    }
+};
+
+// Strings are looked up in the structural index of the input if the log has one (see structural_scan).
+template<typename Parser, inbuilt_expr Expr>
+struct recognizer<Parser, Expr>
+{
+    template<typename Log>
+    static constexpr auto match(std::string_view const input, Log& log) -> match_result
+    {
+        if constexpr (is_quoted_string_expr<std::remove_cvref_t<decltype(Expr)>>
+                      && requires { log.string_length(input); })
+        {
+            if (auto const length = log.string_length(input))
+                return match_result{.valid = true, .length = *length};
+        }
+
+        if constexpr (std::is_invocable_r_v<bool, decltype(Expr.parse), char>)
+        {
+            if (input.empty() || !Expr.parse(input.front()))
+                return match_result{};
+            return match_result{.valid = true, .length = 1};
+        }
+        else if constexpr (std::is_invocable_r_v<std::optional<std::size_t>, decltype(Expr.parse), std::string_view>)
+        {
+            auto const result = Expr.parse(input);
+            if (!result)
+                return match_result{};
+            return match_result{.valid = true, .length = result.value()};
+        }
+    }
+};
+
+// Matches input against a grammar expression without recording any decisions
+template<typename Parser, auto Expr>
+constexpr auto recognize(std::string_view const input) -> match_result
+{
+    null_log log;
+    return recognizer<Parser, Expr>::match(input, log);
+}
+} // namespace parsely::detail
+
+#endif // INCLUDE_PARSELY_UTILITY_RECOGNIZER_HPP
@@ -0,0 +1,118 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_RECORD_VIEW_HPP
+#define INCLUDE_PARSELY_UTILITY_RECORD_VIEW_HPP
+
+#include <parsely/utility/grammar_ast.hpp>
+#include <parsely/utility/grammar_traits.hpp>
+#include <parsely/utility/parse_tree_node.hpp>
+#include <parsely/utility/parser_creator.hpp>
+#include <parsely/utility/recognizer.hpp>
+#include <parsely/utility/structural_index.hpp>
+#include <parsely/utility/text.hpp>
+#include <parsely/utility/utf8.hpp>
+
+#include <structural/inplace_string.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+
+namespace parsely
+{
+// A lazy input range of the parse trees of consecutive matches of the production Symbol in an input
+//
+// Each increment parses the next prefix of the remaining input and advances past it. The tree of the current match is
+// held by the view and its storage is reused for the next match, so the range is single-pass and all iterators share
+// its position. Calling begin() again starts over at the begin of the input. The range ends at the end of the input, at
+// the first input that doesn't match, or at the first empty match; the position of the view tells how much input was
+// consumed. If Symbol recovers from failures (see recover), error nodes are part of the range.
+template<typename Parser, structural::inplace_string Symbol>
+class record_view : public std::ranges::view_interface<record_view<Parser, Symbol>>
+{
+  public:
+    using node_type = parse_tree_node<Parser, detail::nonterminal_expr{Symbol}>;
+
+    class iterator
+    {
+      public:
+        using value_type       = node_type;
+        using difference_type  = std::ptrdiff_t;
+        using iterator_concept = std::input_iterator_tag;
+
+        iterator() = default;
+
+        constexpr explicit iterator(record_view& view)
+            : m_view(&view)
+        {
+        }
+
+        constexpr auto operator*() const -> node_type const& { return m_view->m_node; }
+        constexpr auto operator->() const -> node_type const* { return &m_view->m_node; }
+
+        constexpr auto operator++() -> iterator&
+        {
+            m_view->m_position += m_view->m_node.source_text.size();
+            m_view->parse_next();
+            return *this;
+        }
+
+        constexpr void operator++(int) { ++*this; }
+
+        // Returns the offset of the current match in the input, or of the input that ended the range
+        [[nodiscard]] constexpr auto position() const -> std::size_t { return m_view->m_position; }
+
+        constexpr auto operator==(std::default_sentinel_t /*end*/) const -> bool { return m_view->m_done; }
+
+      private:
+        record_view* m_view = nullptr;
+    };
+
+    record_view() = default;
+
+    // If the grammar matches codepoints, only the valid UTF-8 prefix of input is parsed
+    constexpr explicit record_view(detail::text_t<Parser> const input)
+        : m_input(detail::as_chars(input))
+    {
+        if constexpr (detail::grammar_traits<Parser>::matches_codepoints)
+            m_input = m_input.substr(0, valid_utf8_prefix(m_input));
+    }
+
+    // Parses the first match in the input
+    [[nodiscard]] constexpr auto begin() -> iterator
+    {
+        m_position = 0;
+        parse_next();
+        return iterator(*this);
+    }
+
+    [[nodiscard]] static constexpr auto end() -> std::default_sentinel_t { return std::default_sentinel; }
+
+    // Returns the offset of the current match in the input, or of the input that ended the range
+    [[nodiscard]] constexpr auto position() const -> std::size_t { return m_position; }
+
+  private:
+    constexpr void parse_next()
+    {
+        std::string_view const rest = m_input.substr(m_position);
+        m_done                      = rest.empty();
+        if (m_done)
+            return;
+        detail::parse_valid_into(m_node, rest, m_log, m_structure);
+        m_done = (!m_node.valid && !m_node.recovered) || m_node.source_text.empty();
+    }
+
+    std::string_view     m_input;
+    std::size_t          m_position = 0;
+    bool                 m_done     = true;
+    node_type            m_node;
+    detail::decision_log m_log;
+    structural_index     m_structure;
+};
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_RECORD_VIEW_HPP
@@ -0,0 +1,83 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_SEMANTIC_ACTION_HPP
+#define INCLUDE_PARSELY_UTILITY_SEMANTIC_ACTION_HPP
+
+#include <structural/inplace_string.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace parsely
+{
+// A semantic action that folds the production named Symbol into a value of type T
+//
+// The callable is invoked with the consumed source text and the folded value of the production's expression. It may
+// also accept only the folded value, or only the source text.
+template<structural::inplace_string Symbol, typename T, typename Fn>
+struct semantic_action
+{
+    using value_type = T;
+
+    static constexpr auto symbol = Symbol;
+
+    Fn fn;
+};
+
+// Creates a semantic action that folds the production named Symbol into a value of type T
+template<structural::inplace_string Symbol, typename T, typename Fn>
+constexpr auto action(Fn fn) -> semantic_action<Symbol, T, Fn>
+{
+    return semantic_action<Symbol, T, Fn>{std::move(fn)};
+}
+
+// The result of folding an input string
+template<typename T, typename Text = std::string_view>
+struct fold_result
+{
+    bool             valid = false; // True if parsing successful
+    Text             source_text;   // Consumed source text
+    std::optional<T> value;         // Folded value - empty iff !valid
+
+    constexpr explicit operator bool() const { return valid; };
+
+    constexpr auto operator*() const& -> T const& { return *value; }
+    constexpr auto operator*() & -> T& { return *value; }
+    constexpr auto operator*() && -> T&& { return *std::move(value); }
+
+    constexpr auto operator->() const -> T const* { return &*value; }
+    constexpr auto operator->() -> T* { return &*value; }
+};
+
+namespace detail
+{
+template<structural::inplace_string Symbol, typename... Actions>
+consteval auto find_action_index(std::type_identity<std::tuple<Actions...>> /*unused*/) -> std::size_t
+{
+    std::size_t i = 0;
+    ((std::remove_cvref_t<Actions>::symbol == Symbol || (++i, false)) || ...);
+    return i;
+}
+
+template<typename Fn, typename Text, typename Value>
+constexpr auto invoke_action(Fn const& fn, Text const source_text, Value&& value) -> decltype(auto)
+{
+    if constexpr (std::is_invocable_v<Fn const&, Text, Value&&>)
+        return std::invoke(fn, source_text, std::forward<Value>(value));
+    else if constexpr (std::is_invocable_v<Fn const&, Value&&>)
+        return std::invoke(fn, std::forward<Value>(value));
+    else
+        return std::invoke(fn, source_text);
+}
+} // namespace detail
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_SEMANTIC_ACTION_HPP
@@ -0,0 +1,156 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_SHARED_INDIRECT_HPP
+#define INCLUDE_PARSELY_UTILITY_SHARED_INDIRECT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace parsely
+{
+// Stores an immutable T on the heap and shares it between copies using reference counting. This shared_indirect
+// implementation is nullable.
+//
+// Copies are O(1). If ThreadSafe is true, the reference count is updated atomically, so copies may be created and
+// destroyed concurrently from multiple threads.
+template<typename T, bool ThreadSafe = false>
+class shared_indirect
+{
+  public:
+    constexpr shared_indirect() noexcept = default;
+    constexpr explicit shared_indirect(std::nullptr_t) noexcept {}
+    constexpr /* implicit */ shared_indirect(T value) // NOLINT(*-explicit-constructor)
+        : m_block(new control_block{.value = std::move(value)})
+    {
+    }
+    template<typename... Args>
+    explicit constexpr shared_indirect(std::in_place_t /*unused*/, Args&&... args)
+        : m_block(new control_block{.value = T(std::forward<Args>(args)...)})
+    {
+    }
+
+    constexpr shared_indirect(shared_indirect const& other) noexcept
+        : m_block(other.m_block)
+    {
+        if (m_block != nullptr)
+            increment(m_block->count);
+    }
+
+    constexpr shared_indirect(shared_indirect&& other) noexcept
+        : m_block(std::exchange(other.m_block, nullptr))
+    {
+    }
+
+    constexpr auto operator=(shared_indirect const& other) noexcept -> shared_indirect&
+    {
+        shared_indirect(other).swap(*this);
+        return *this;
+    }
+
+    constexpr auto operator=(shared_indirect&& other) noexcept -> shared_indirect&
+    {
+        shared_indirect(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    constexpr auto operator=(std::nullptr_t) noexcept -> shared_indirect&
+    {
+        shared_indirect().swap(*this);
+        return *this;
+    }
+
+    constexpr ~shared_indirect()
+    {
+        if (m_block != nullptr && decrement(m_block->count) == 0)
+            delete m_block;
+    }
+
+    constexpr void swap(shared_indirect& other) noexcept { std::swap(m_block, other.m_block); }
+
+    [[nodiscard]] constexpr explicit operator bool() const noexcept { return m_block != nullptr; }
+
+    constexpr auto operator*() const -> T const& { return m_block->value; }
+    constexpr auto operator->() const -> T const* { return &m_block->value; }
+
+    // Returns the number of shared_indirects sharing the stored value, or 0 if this is null
+    [[nodiscard]] constexpr auto use_count() const noexcept -> std::size_t
+    {
+        return m_block != nullptr ? load(m_block->count) : 0;
+    }
+
+    constexpr auto operator==(shared_indirect const& other) const -> bool
+    {
+        if (m_block == other.m_block)
+            return true;
+        if (!static_cast<bool>(*this) || !static_cast<bool>(other))
+            return false;
+        return m_block->value == other.m_block->value;
+    }
+
+    constexpr auto operator==(std::nullptr_t) const -> bool { return !static_cast<bool>(*this); }
+    constexpr auto operator==(T const& other) const -> bool
+    {
+        return static_cast<bool>(*this) && m_block->value == other;
+    }
+
+  private:
+    struct control_block
+    {
+        T value;
+        alignas(std::atomic_ref<std::size_t>::required_alignment) std::size_t count = 1;
+    };
+
+    static constexpr auto load(std::size_t& count) noexcept -> std::size_t
+    {
+        if consteval
+        {
+            return count;
+        }
+        else
+        {
+            if constexpr (ThreadSafe)
+                return std::atomic_ref(count).load(std::memory_order_relaxed);
+            else
+                return count;
+        }
+    }
+
+    static constexpr void increment(std::size_t& count) noexcept
+    {
+        if consteval
+        {
+            ++count;
+        }
+        else
+        {
+            if constexpr (ThreadSafe)
+                std::atomic_ref(count).fetch_add(1, std::memory_order_relaxed);
+            else
+                ++count;
+        }
+    }
+
+    static constexpr auto decrement(std::size_t& count) noexcept -> std::size_t
+    {
+        if consteval
+        {
+            return --count;
+        }
+        else
+        {
+            if constexpr (ThreadSafe)
+                return std::atomic_ref(count).fetch_sub(1, std::memory_order_acq_rel) - 1;
+            else
+                return --count;
+        }
+    }
+
+    control_block* m_block = nullptr;
+};
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_SHARED_INDIRECT_HPP
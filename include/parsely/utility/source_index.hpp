@@ -0,0 +1,260 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_SOURCE_INDEX_HPP
+#define INCLUDE_PARSELY_UTILITY_SOURCE_INDEX_HPP
+
+#include <parsely/utility/text.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace parsely
+{
+// A position in an input, as line and column numbers
+struct source_location
+{
+    std::size_t line   = 1; // 1-based line number
+    std::size_t column = 1; // 1-based column, counting the codepoints of UTF-8 encoded input
+
+    constexpr auto operator==(source_location const&) const -> bool = default;
+};
+
+namespace detail
+{
+// Counts the newlines in input, looking at 16 (SSE2) or 8 (otherwise) bytes at a time
+constexpr auto count_newlines(std::string_view const input) -> std::size_t
+{
+    if consteval
+    {
+        return static_cast<std::size_t>(std::ranges::count(input, '\n'));
+    }
+    else
+    {
+        std::size_t count = 0;
+        std::size_t i     = 0;
+#if defined(__SSE2__)
+        __m128i const newline = _mm_set1_epi8('\n');
+        for (; i + 16 <= input.size(); i += 16)
+        {
+            __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input.data() + i));
+            auto const    mask  = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+            count += static_cast<std::size_t>(std::popcount(mask));
+        }
+#endif
+        constexpr std::uint64_t low_bits  = 0x7F7F'7F7F'7F7F'7F7F;
+        constexpr std::uint64_t newlines  = 0x0A0A'0A0A'0A0A'0A0A;
+        for (; i + 8 <= input.size(); i += 8)
+        {
+            std::uint64_t chunk = 0;
+            std::memcpy(&chunk, input.data() + i, sizeof(chunk));
+            // Sets the high bit of exactly the bytes that are zero after xoring with the newlines
+            std::uint64_t const x = chunk ^ newlines;
+            count += static_cast<std::size_t>(std::popcount(~(((x & low_bits) + low_bits) | x | low_bits)));
+        }
+        return count + static_cast<std::size_t>(std::ranges::count(input.substr(i), '\n'));
+    }
+}
+
+// Appends the offset of the char after each newline in input to line_starts
+constexpr void find_line_starts(std::string_view const input, std::vector<std::size_t>& line_starts)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    if !consteval
+    {
+        __m128i const newline = _mm_set1_epi8('\n');
+        for (; i + 16 <= input.size(); i += 16)
+        {
+            __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input.data() + i));
+            for (auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline))); mask != 0;
+                 mask &= mask - 1)
+                line_starts.push_back(i + static_cast<std::size_t>(std::countr_zero(mask)) + 1);
+        }
+    }
+#endif
+    for (std::size_t at = input.find('\n', i); at != std::string_view::npos; at = input.find('\n', at + 1))
+        line_starts.push_back(at + 1);
+}
+
+// Counts the codepoints of UTF-8 encoded text, i.e. the bytes that aren't continuation bytes, looking at 16 (SSE2) or
+// 8 (otherwise) bytes at a time
+//
+// Invalid UTF-8 is counted byte by byte, except for stray continuation bytes.
+constexpr auto count_codepoints(std::string_view const text) -> std::size_t
+{
+    constexpr auto is_leading = [](char const c) { return (static_cast<unsigned char>(c) & 0xC0) != 0x80; };
+    if consteval
+    {
+        return static_cast<std::size_t>(std::ranges::count_if(text, is_leading));
+    }
+    else
+    {
+        std::size_t count = 0;
+        std::size_t i     = 0;
+#if defined(__SSE2__)
+        // Continuation bytes are 0x80 to 0xBF, i.e. the signed bytes up to -65
+        __m128i const last_continuation = _mm_set1_epi8(-65);
+        for (; i + 16 <= text.size(); i += 16)
+        {
+            __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(text.data() + i));
+            auto const    mask  = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, last_continuation)));
+            count += static_cast<std::size_t>(std::popcount(mask));
+        }
+#endif
+        constexpr std::uint64_t low_bits = 0x0101'0101'0101'0101;
+        for (; i + 8 <= text.size(); i += 8)
+        {
+            std::uint64_t chunk = 0;
+            std::memcpy(&chunk, text.data() + i, sizeof(chunk));
+            // Keeps the lowest bit of exactly the bytes whose top bits are 10
+            count += 8 - static_cast<std::size_t>(std::popcount((chunk >> 7) & ~(chunk >> 6) & low_bits));
+        }
+        return count + static_cast<std::size_t>(std::ranges::count_if(text.substr(i), is_leading));
+    }
+}
+} // namespace detail
+
+// Maps offsets into an input to lines and columns
+//
+// The table of line starts is built on first use, by counting the newlines of the input in blocks to allocate the table
+// once and then collecting their offsets. Each lookup is a binary search in the table followed by counting the
+// codepoints between the start of the line and the offset, so diagnostics for large inputs don't scan the input from
+// the start. If a line is longer than checkpoint_interval bytes, such as that of minified input, the number of
+// codepoints before every checkpoint_interval bytes of the input is stored along with the table, and columns are
+// counted from the nearest checkpoints instead. Lines are separated by "\n"; a "\r" before it counts as the last char
+// of its line.
+//
+// The index views the input, which must outlive it. Since the table is built lazily, an index must not be used by
+// multiple threads at once unless build() has been called.
+class source_index
+{
+  public:
+    static constexpr std::size_t checkpoint_interval = 4096;
+
+    constexpr source_index() = default;
+
+    constexpr explicit source_index(std::string_view const input)
+        : m_input(input)
+    {
+    }
+
+    template<input_text Text>
+        requires(!std::is_same_v<Text, std::string_view>)
+    explicit source_index(Text const input)
+        : m_input(detail::as_chars(input))
+    {
+    }
+
+    // Views another input, keeping the storage of the table
+    constexpr void reset(std::string_view const input)
+    {
+        m_input = input;
+        m_line_starts.clear();
+        m_checkpoints.clear();
+    }
+
+    // Builds the table of line starts, unless it has been built already
+    constexpr void build()
+    {
+        if (!m_line_starts.empty())
+            return;
+        m_line_starts.reserve(detail::count_newlines(m_input) + 1);
+        m_line_starts.push_back(0);
+        detail::find_line_starts(m_input, m_line_starts);
+        if (has_long_lines())
+            build_checkpoints();
+    }
+
+    // Returns the line and column of the char at offset, or of the end of the input if offset is past it
+    [[nodiscard]] constexpr auto location(std::size_t offset) -> source_location
+    {
+        build();
+        offset                 = std::min(offset, m_input.size());
+        auto const        next = std::ranges::upper_bound(m_line_starts, offset);
+        std::size_t const line = static_cast<std::size_t>(next - m_line_starts.begin());
+        std::size_t const from = *(next - 1);
+        return source_location{.line = line, .column = count_codepoints(from, offset) + 1};
+    }
+
+    // Returns the line and column of the start of text, which must be a view into the input, such as the source text of
+    // a parse tree node
+    template<input_text Text>
+    [[nodiscard]] constexpr auto location(Text const text) -> source_location
+    {
+        std::string_view const chars = detail::as_chars(text);
+        return location(static_cast<std::size_t>(chars.data() - m_input.data()));
+    }
+
+    // Returns the number of lines of the input
+    [[nodiscard]] constexpr auto line_count() -> std::size_t
+    {
+        build();
+        return m_line_starts.size();
+    }
+
+    // Returns the line with the given 1-based number, without its newline
+    [[nodiscard]] constexpr auto line(std::size_t const number) -> std::string_view
+    {
+        build();
+        std::size_t const begin = m_line_starts[number - 1];
+        std::size_t const end   = number < m_line_starts.size() ? m_line_starts[number] - 1 : m_input.size();
+        return m_input.substr(begin, end - begin);
+    }
+
+  private:
+    // Returns true if a line of the input is longer than checkpoint_interval bytes
+    [[nodiscard]] constexpr auto has_long_lines() const -> bool
+    {
+        auto const longer = [](std::size_t const begin, std::size_t const next)
+        { return next - begin > checkpoint_interval; };
+        return m_input.size() - m_line_starts.back() > checkpoint_interval
+            || std::ranges::adjacent_find(m_line_starts, longer) != m_line_starts.end();
+    }
+
+    constexpr void build_checkpoints()
+    {
+        m_checkpoints.reserve(m_input.size() / checkpoint_interval + 1);
+        std::size_t count = 0;
+        for (std::size_t begin = 0; begin <= m_input.size(); begin += checkpoint_interval)
+        {
+            m_checkpoints.push_back(count);
+            count += detail::count_codepoints(m_input.substr(begin, checkpoint_interval));
+        }
+    }
+
+    // Counts the codepoints between the offsets from and to of a line of the input
+    [[nodiscard]] constexpr auto count_codepoints(std::size_t const from, std::size_t const to) const -> std::size_t
+    {
+        if (to - from <= checkpoint_interval) // The checkpoints are only built if a line is longer
+            return detail::count_codepoints(m_input.substr(from, to - from));
+        return codepoints_before(to) - codepoints_before(from);
+    }
+
+    // Returns the number of codepoints of the input before offset, using the checkpoints
+    [[nodiscard]] constexpr auto codepoints_before(std::size_t const offset) const -> std::size_t
+    {
+        std::size_t const checkpoint = offset / checkpoint_interval;
+        std::size_t const begin      = checkpoint * checkpoint_interval;
+        return m_checkpoints[checkpoint] + detail::count_codepoints(m_input.substr(begin, offset - begin));
+    }
+
+    std::string_view         m_input;
+    std::vector<std::size_t> m_line_starts; // Offset of the first char of each line; empty until built
+    std::vector<std::size_t> m_checkpoints; // Codepoints before every checkpoint_interval bytes, if a line is longer
+};
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_SOURCE_INDEX_HPP
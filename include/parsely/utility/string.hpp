@@ -42,6 +42,23 @@ constexpr auto is_alnum(char const c) -> bool
 {
     return is_alpha(c) || is_digit(c);
 }
+
+// Checks whether a character is one of the hexadecimal digit characters '0' through '9', 'a' through 'f' or 'A' through
+// 'F'
+constexpr auto is_xdigit(char const c) -> bool
+{
+    return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Returns the value of a hexadecimal digit character
+constexpr auto hex_value(char const c) -> unsigned char
+{
+    if (is_digit(c))
+        return static_cast<unsigned char>(c - '0');
+    if (c >= 'a' && c <= 'f')
+        return static_cast<unsigned char>(c - 'a' + 10);
+    return static_cast<unsigned char>(c - 'A' + 10);
+}
 } // namespace parsely
 
 #endif // STRING_HPP
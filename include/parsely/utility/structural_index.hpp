@@ -0,0 +1,300 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_STRUCTURAL_INDEX_HPP
+#define INCLUDE_PARSELY_UTILITY_STRUCTURAL_INDEX_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace parsely
+{
+namespace detail
+{
+// Returns the offset of the first '"' or '\\' in input at or after from, or npos if there is none
+//
+// Input is scanned 16 bytes at a time if SSE2 is available.
+constexpr auto find_quote_or_escape(std::string_view const input, std::size_t from) -> std::size_t
+{
+#if defined(__SSE2__)
+    if !consteval
+    {
+        __m128i const quote  = _mm_set1_epi8('"');
+        __m128i const escape = _mm_set1_epi8('\\');
+        for (; from + 16 <= input.size(); from += 16)
+        {
+            __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input.data() + from));
+            auto const    mask  = static_cast<unsigned>(
+                _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, escape))));
+            if (mask != 0)
+                return from + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+#endif
+    return input.find_first_of("\"\\", from);
+}
+} // namespace detail
+
+// Matches a string delimited by '"', in which '\\' escapes the next char, and returns its length including the quotes
+//
+// This is the matcher of $string. Escape sequences are only checked to be complete, and strings may span lines.
+constexpr auto match_quoted_string(std::string_view const input) -> std::optional<std::size_t>
+{
+    if (!input.starts_with('"'))
+        return std::nullopt;
+    for (std::size_t at = detail::find_quote_or_escape(input, 1); at != std::string_view::npos;
+         at             = detail::find_quote_or_escape(input, at + 2))
+    {
+        if (input[at] == '"')
+            return at + 1;
+    }
+    return std::nullopt;
+}
+
+namespace detail
+{
+// Returns a mask of the bytes of a 64 byte block that equal c
+constexpr auto block_mask(char const* const block, char const c) -> std::uint64_t
+{
+#if defined(__SSE2__)
+    if !consteval
+    {
+        __m128i const needle = _mm_set1_epi8(c);
+        std::uint64_t mask   = 0;
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + 16 * i));
+            auto const    part  = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+            mask |= static_cast<std::uint64_t>(part) << (16 * i);
+        }
+        return mask;
+    }
+#endif
+    std::uint64_t mask = 0;
+    for (std::size_t i = 0; i < 64; ++i)
+        mask |= static_cast<std::uint64_t>(block[i] == c) << i;
+    return mask;
+}
+
+// Sets each bit to the xor of itself and all lower bits, turning a mask of quotes into a mask of the chars from each
+// opening quote up to, but excluding, its closing quote
+constexpr auto prefix_xor(std::uint64_t mask) -> std::uint64_t
+{
+    for (unsigned shift = 1; shift < 64; shift *= 2)
+        mask ^= mask << shift;
+    return mask;
+}
+} // namespace detail
+
+// An index of the structural chars of an input: the quotes delimiting strings and the brackets outside of them
+//
+// This is the first stage of parsing JSON-like input as done by simdjson. The input is classified 64 bytes at a time,
+// chars escaped by backslashes are dropped, and a prefix xor of the remaining quotes masks out the strings, so brackets
+// inside of them are ignored. Each quote and bracket is paired with its counterpart while the index is built, so a
+// string or a bracketed section can be skipped without looking at its contents. Quotes are assumed to only ever delimit
+// strings, as in JSON. The quote of an unterminated string and mismatched brackets are left unpaired.
+//
+// Parsers with the structural_scan policy only index quotes. Brackets are only indexed on request, for skipping
+// sections of an input without parsing them.
+//
+// Lookups search forward from the previous one, so looking up the structural chars of an input in order takes amortized
+// constant time per lookup. An index must not be used by multiple threads at once.
+class structural_index
+{
+  public:
+    static constexpr std::size_t npos = std::string_view::npos;
+
+    constexpr structural_index() = default;
+
+    // Indexes input; brackets lists pairs of opening and closing brackets to index, such as "[]{}"
+    constexpr explicit structural_index(std::string_view const input, std::string_view const brackets = {})
+    {
+        reset(input, brackets);
+    }
+
+    // Indexes another input, keeping the storage of the index
+    constexpr void reset(std::string_view const input, std::string_view const brackets = {})
+    {
+        m_entries.clear();
+        m_cursor = 0;
+
+        std::vector<std::size_t> open_brackets; // Indices of the entries of brackets that are still open
+        std::size_t              open_quote = npos;
+
+        std::uint64_t escaped_carry   = 0; // 1 if the first char of the next block is escaped
+        std::uint64_t in_string_carry = 0; // All ones if the next block starts inside of a string
+        for (std::size_t base = 0; base < input.size(); base += 64)
+        {
+            std::array<char, 64> padded{};
+            char const*          block = input.data() + base;
+            if (input.size() - base < 64)
+            {
+                std::ranges::copy(input.substr(base), padded.begin());
+                block = padded.data();
+            }
+
+            // Each backslash that isn't escaped itself escapes the next char
+            std::uint64_t backslashes = detail::block_mask(block, '\\') & ~escaped_carry;
+            std::uint64_t escaped     = escaped_carry;
+            escaped_carry             = 0;
+            for (; backslashes != 0; backslashes &= backslashes - 1)
+            {
+                std::uint64_t const backslash = backslashes & -backslashes;
+                if (backslash == std::uint64_t{1} << 63)
+                    escaped_carry = 1;
+                escaped |= backslash << 1;
+                backslashes &= ~(backslash << 1);
+            }
+
+            std::uint64_t const quotes    = detail::block_mask(block, '"') & ~escaped;
+            std::uint64_t const in_string = detail::prefix_xor(quotes) ^ in_string_carry;
+            in_string_carry               = in_string >> 63 != 0 ? ~std::uint64_t{0} : 0;
+
+            std::uint64_t structurals = 0;
+            for (char const bracket : brackets)
+                structurals |= detail::block_mask(block, bracket);
+            structurals = (structurals & ~in_string & ~escaped) | quotes;
+
+            for (; structurals != 0; structurals &= structurals - 1)
+            {
+                std::size_t const offset = base + static_cast<std::size_t>(std::countr_zero(structurals));
+                std::size_t const index  = m_entries.size();
+                char const        c      = input[offset];
+                m_entries.push_back(entry{.offset = offset, .partner = npos, .quote = c == '"'});
+                if (c == '"')
+                {
+                    if (open_quote == npos)
+                    {
+                        open_quote = index;
+                    }
+                    else
+                    {
+                        pair(open_quote, index);
+                        open_quote = npos;
+                    }
+                }
+                else if (brackets.find(c) % 2 == 0)
+                {
+                    open_brackets.push_back(index);
+                }
+                else if (!open_brackets.empty()
+                         && brackets.find(input[m_entries[open_brackets.back()].offset]) + 1 == brackets.find(c))
+                {
+                    pair(open_brackets.back(), index);
+                    open_brackets.pop_back();
+                }
+            }
+        }
+    }
+
+    // Returns the offset of the quote closing the string that the quote at offset opens, or npos if there is none
+    [[nodiscard]] constexpr auto closing_quote(std::size_t const offset) -> std::size_t
+    {
+        entry const* const e = find(offset);
+        return e != nullptr && e->quote && e->partner > offset ? e->partner : npos;
+    }
+
+    // Returns the offset of the bracket matching the bracket at offset, or npos if there is none
+    [[nodiscard]] constexpr auto matching_bracket(std::size_t const offset) -> std::size_t
+    {
+        entry const* const e = find(offset);
+        return e != nullptr && !e->quote ? e->partner : npos;
+    }
+
+    // Returns the number of indexed quotes and brackets
+    [[nodiscard]] constexpr auto size() const -> std::size_t { return m_entries.size(); }
+
+  private:
+    struct entry
+    {
+        std::size_t offset;
+        std::size_t partner; // Offset of the matching quote or bracket, or npos
+        bool        quote;
+    };
+
+    constexpr void pair(std::size_t const first, std::size_t const second)
+    {
+        m_entries[first].partner  = m_entries[second].offset;
+        m_entries[second].partner = m_entries[first].offset;
+    }
+
+    // Returns the entry of the structural char at offset, or nullptr if there is none
+    constexpr auto find(std::size_t const offset) -> entry const*
+    {
+        // Gallop forward from the previous lookup, or search the whole index when going backwards
+        std::size_t first = m_cursor < m_entries.size() && m_entries[m_cursor].offset <= offset ? m_cursor : 0;
+        std::size_t step  = 1;
+        while (first + step < m_entries.size() && m_entries[first + step].offset <= offset)
+        {
+            first += step;
+            step *= 2;
+        }
+        auto const begin = m_entries.begin() + static_cast<std::ptrdiff_t>(first);
+        auto const end   = m_entries.begin() + static_cast<std::ptrdiff_t>(std::min(first + step, m_entries.size()));
+        auto const it    = std::ranges::lower_bound(begin, end, offset, {}, &entry::offset);
+        if (it == end || it->offset != offset)
+            return nullptr;
+        m_cursor = static_cast<std::size_t>(it - m_entries.begin());
+        return &*it;
+    }
+
+    std::vector<entry> m_entries; // Indexed quotes and brackets, in input order
+    std::size_t        m_cursor = 0; // Entry found by the previous lookup
+};
+
+namespace detail
+{
+// A decision log forwarding to Log, through which recognizers look up the strings of input in a structural_index
+//
+// See structural_scan.
+template<typename Log>
+class indexed_log
+{
+  public:
+    constexpr indexed_log(Log& log, structural_index& index, std::string_view const input)
+        : m_log(log)
+        , m_index(index)
+        , m_input(input)
+    {
+    }
+
+    [[nodiscard]] constexpr auto mark() const -> std::size_t { return m_log.mark(); }
+    constexpr void               push(std::size_t const decision) { m_log.push(decision); }
+    constexpr void               set(std::size_t const at, std::size_t const decision) { m_log.set(at, decision); }
+    constexpr void               truncate(std::size_t const at) { m_log.truncate(at); }
+    constexpr void               clear() { m_log.clear(); }
+    constexpr void recover(std::size_t const at, std::string_view const skipped) { m_log.recover(at, skipped); }
+
+    [[nodiscard]] constexpr auto decisions() const { return m_log.decisions(); }
+
+    // Returns the length of the $string starting at input, or std::nullopt if the index doesn't know where it ends
+    [[nodiscard]] constexpr auto string_length(std::string_view const input) -> std::optional<std::size_t>
+    {
+        auto const        offset  = static_cast<std::size_t>(input.data() - m_input.data());
+        std::size_t const closing = m_index.closing_quote(offset);
+        if (closing == structural_index::npos)
+            return std::nullopt;
+        return closing - offset + 1;
+    }
+
+  private:
+    Log&                    m_log;
+    structural_index&       m_index;
+    std::string_view        m_input; // The indexed input, to compute offsets
+};
+} // namespace detail
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_STRUCTURAL_INDEX_HPP
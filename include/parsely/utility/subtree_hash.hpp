@@ -0,0 +1,79 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_SUBTREE_HASH_HPP
+#define INCLUDE_PARSELY_UTILITY_SUBTREE_HASH_HPP
+
+#include <parsely/utility/grammar_traits.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace parsely
+{
+// Combines values and bytes into a 64 bit hash, used for the subtree hashes of parse trees (see hashed_tree)
+//
+// The hash isn't cryptographic: Trees built from untrusted input may be crafted to collide.
+class subtree_hasher
+{
+  public:
+    constexpr void mix(std::uint64_t const value)
+    {
+        m_state = std::rotl((m_state ^ value) * 0x9E37'79B9'7F4A'7C15, 31) * 0xBF58'476D'1CE4'E5B9;
+    }
+
+    // Mixes bytes 8 at a time, followed by their number
+    constexpr void mix_bytes(std::string_view const bytes)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= bytes.size(); i += 8)
+            mix(load(bytes.substr(i, 8)));
+        if (i != bytes.size())
+            mix(load(bytes.substr(i)));
+        mix(bytes.size());
+    }
+
+    [[nodiscard]] constexpr auto finish() const -> std::uint64_t
+    {
+        std::uint64_t h = m_state;
+        h ^= h >> 33;
+        h *= 0xFF51'AFD7'ED55'8CCD;
+        h ^= h >> 33;
+        h *= 0xC4CE'B9FE'1A85'EC53;
+        h ^= h >> 33;
+        return h;
+    }
+
+  private:
+    // Reads up to 8 bytes as a little endian integer; compilers turn this into a single load
+    static constexpr auto load(std::string_view const bytes) -> std::uint64_t
+    {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < bytes.size(); ++i)
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+        return value;
+    }
+
+    std::uint64_t m_state = 0x243F'6A88'85A3'08D3;
+};
+
+namespace detail
+{
+// Stands in for the subtree hash of symbol nodes of parsers without the hashed_tree policy
+struct no_subtree_hash
+{
+    constexpr auto operator==(no_subtree_hash const&) const -> bool = default;
+};
+
+// The type of the subtree hash stored in the symbol nodes of Parser
+template<typename Parser>
+using subtree_hash_t = std::conditional_t<grammar_traits<Parser>::hashes_subtrees, std::uint64_t, no_subtree_hash>;
+} // namespace detail
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_SUBTREE_HASH_HPP
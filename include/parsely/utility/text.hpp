@@ -0,0 +1,70 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_TEXT_HPP
+#define INCLUDE_PARSELY_UTILITY_TEXT_HPP
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace parsely
+{
+// The types of input that parsers accept
+//
+// Parsers always match chars. Other input types are viewed as chars, which may alias any object.
+template<typename Text>
+concept input_text = std::is_same_v<Text, std::string_view> || std::is_same_v<Text, std::u8string_view>
+                     || std::is_same_v<Text, std::span<std::byte const>>;
+
+// A range of an input, given as offsets of its first char and of the char after it
+struct source_span
+{
+    std::size_t begin = 0;
+    std::size_t end   = 0;
+
+    [[nodiscard]] constexpr auto size() const -> std::size_t { return end - begin; }
+
+    constexpr auto operator==(source_span const&) const -> bool = default;
+};
+
+namespace detail
+{
+// Views text as chars
+//
+// All overloads are constexpr, so they may be called from the constexpr parse functions of all input types. Viewing
+// other types as chars aliases them, though, which constant evaluation doesn't allow. A view can't refer to a copy
+// either, so like for from_chars(), only inputs of std::string_view are parsed at compile time.
+constexpr auto as_chars(std::string_view const text) -> std::string_view
+{
+    return text;
+}
+
+constexpr auto as_chars(std::u8string_view const text) -> std::string_view
+{
+    return std::string_view{reinterpret_cast<char const*>(text.data()), text.size()};
+}
+
+constexpr auto as_chars(std::span<std::byte const> const text) -> std::string_view
+{
+    return std::string_view{reinterpret_cast<char const*>(text.data()), text.size()};
+}
+
+// Views chars that were obtained from as_chars() as Text again
+template<input_text Text>
+constexpr auto from_chars(std::string_view const chars) -> Text
+{
+    if constexpr (std::is_same_v<Text, std::string_view>)
+        return chars;
+    else if constexpr (std::is_same_v<Text, std::u8string_view>)
+        return Text{reinterpret_cast<char8_t const*>(chars.data()), chars.size()};
+    else
+        return Text{reinterpret_cast<std::byte const*>(chars.data()), chars.size()};
+}
+} // namespace detail
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_TEXT_HPP
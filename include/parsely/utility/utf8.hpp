@@ -0,0 +1,193 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_UTF8_HPP
+#define INCLUDE_PARSELY_UTILITY_UTF8_HPP
+
+#include <parsely/utility/unicode_tables.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace parsely
+{
+// A codepoint decoded from UTF-8
+struct decoded_codepoint
+{
+    char32_t    value  = 0;
+    std::size_t length = 0; // Number of bytes the codepoint is encoded in
+};
+
+// Decodes the codepoint at the start of input
+//
+// Returns std::nullopt if input is empty or doesn't start with a valid UTF-8 sequence. Overlong encodings, surrogates
+// and codepoints beyond U+10FFFF are invalid.
+constexpr auto decode_utf8(std::string_view const input) -> std::optional<decoded_codepoint>
+{
+    if (input.empty())
+        return std::nullopt;
+
+    auto const byte = [&](std::size_t const i) { return static_cast<std::uint8_t>(input[i]); };
+
+    std::uint8_t const lead = byte(0);
+    if (lead < 0x80)
+        return decoded_codepoint{.value = lead, .length = 1};
+
+    std::size_t length = 0;
+    char32_t    value  = 0;
+    char32_t    min    = 0;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        length = 2;
+        value  = lead & 0x1F;
+        min    = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        length = 3;
+        value  = lead & 0x0F;
+        min    = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        length = 4;
+        value  = lead & 0x07;
+        min    = 0x10000;
+    }
+    else
+    {
+        return std::nullopt;
+    }
+
+    if (input.size() < length)
+        return std::nullopt;
+    for (std::size_t i = 1; i < length; ++i)
+    {
+        if ((byte(i) & 0xC0) != 0x80)
+            return std::nullopt;
+        value = (value << 6) | (byte(i) & 0x3F);
+    }
+
+    if (value < min || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF))
+        return std::nullopt;
+    return decoded_codepoint{.value = value, .length = length};
+}
+
+namespace detail
+{
+// Returns the length of the run of ASCII chars at the start of input, looking at 16 (SSE2) or 8 (otherwise) bytes at a
+// time. The result may be shorter than the actual run.
+inline auto ascii_prefix(std::string_view const input) -> std::size_t
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= input.size(); i += 16)
+    {
+        __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input.data() + i));
+        if (_mm_movemask_epi8(chunk) != 0)
+            return i;
+    }
+#endif
+    for (; i + 8 <= input.size(); i += 8)
+    {
+        std::uint64_t chunk = 0;
+        std::memcpy(&chunk, input.data() + i, sizeof(chunk));
+        if ((chunk & 0x8080'8080'8080'8080) != 0)
+            return i;
+    }
+    return i;
+}
+
+// Returns true if the sorted ranges contain c
+template<std::size_t N>
+constexpr auto contains(std::array<codepoint_range, N> const& ranges, char32_t const c) -> bool
+{
+    auto const it = std::ranges::lower_bound(ranges, c, {}, &codepoint_range::last);
+    return it != ranges.end() && it->first <= c;
+}
+} // namespace detail
+
+// Returns the length of the longest prefix of input that is valid UTF-8
+//
+// Runs of ASCII chars are skipped in blocks, so mostly ASCII inputs are validated at close to memory speed.
+constexpr auto valid_utf8_prefix(std::string_view const input) -> std::size_t
+{
+    std::size_t i = 0;
+    while (i < input.size())
+    {
+        if !consteval
+        {
+            i += detail::ascii_prefix(input.substr(i));
+        }
+        else
+        {
+            // Decoding every char is too expensive for large inputs in constant expressions
+            while (i < input.size() && static_cast<unsigned char>(input[i]) < 0x80)
+                ++i;
+        }
+        if (i == input.size())
+            break;
+        auto const c = decode_utf8(input.substr(i));
+        if (!c)
+            break;
+        i += c->length;
+    }
+    return i;
+}
+
+// Checks whether input is valid UTF-8
+constexpr auto is_valid_utf8(std::string_view const input) -> bool
+{
+    return valid_utf8_prefix(input) == input.size();
+}
+
+// Returns true for every codepoint
+constexpr auto is_codepoint(char32_t /*c*/) -> bool
+{
+    return true;
+}
+
+// Checks whether a codepoint is a letter (general category L)
+constexpr auto is_letter(char32_t const c) -> bool
+{
+    if (c < 0x80)
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    return detail::contains(detail::letter_ranges, c);
+}
+
+// Checks whether a codepoint is a decimal digit (general category Nd)
+constexpr auto is_decimal_digit(char32_t const c) -> bool
+{
+    if (c < 0x80)
+        return c >= '0' && c <= '9';
+    return detail::contains(detail::decimal_digit_ranges, c);
+}
+
+// Checks whether a codepoint is whitespace (property White_Space)
+constexpr auto is_white_space(char32_t const c) -> bool
+{
+    return detail::contains(detail::white_space_ranges, c);
+}
+
+// Matches a single UTF-8 encoded codepoint for which Predicate returns true and returns its length
+template<auto Predicate>
+constexpr auto match_codepoint(std::string_view const input) -> std::optional<std::size_t>
+{
+    auto const c = decode_utf8(input);
+    if (!c || !Predicate(c->value))
+        return std::nullopt;
+    return c->length;
+}
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_UTF8_HPP
@@ -0,0 +1,189 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_VISITOR_HPP
+#define INCLUDE_PARSELY_UTILITY_VISITOR_HPP
+
+#include <parsely/utility/parse_tree_node.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace parsely
+{
+// Tells a traversal how to proceed after entering a node
+enum class traverse_control
+{
+    descend, // Visit the children of the node
+    skip,    // Don't visit the children of the node
+    stop,    // Abort the traversal
+};
+
+namespace detail
+{
+template<typename Visitor, typename Node>
+constexpr auto call_enter(Visitor& visitor, Node const& node) -> traverse_control
+{
+    if constexpr (requires {
+                      { visitor.enter(node) } -> std::same_as<traverse_control>;
+                  })
+        return visitor.enter(node);
+    else if constexpr (requires { visitor.enter(node); })
+        visitor.enter(node);
+    else if constexpr (requires {
+                           { visitor(node) } -> std::same_as<traverse_control>;
+                       })
+        return visitor(node);
+    else if constexpr (requires { visitor(node); })
+        visitor(node);
+    return traverse_control::descend;
+}
+
+template<typename Visitor, typename Node>
+constexpr void call_leave(Visitor& visitor, Node const& node)
+{
+    if constexpr (requires { visitor.leave(node); })
+        visitor.leave(node);
+}
+
+// Depth-first traversal driven by an explicit stack
+//
+// Each frame stores a type-erased node along with a step function instantiated for the node's type. A frame's state is
+// 0 before the node is entered and 1 + the index of the next child to visit afterwards. Children are pushed one at a
+// time, so the stack never holds more than one frame per tree level.
+template<typename Visitor>
+struct traversal
+{
+    struct frame
+    {
+        void const* node;
+        auto (*step)(traversal&, frame&) -> bool;
+        std::size_t state;
+    };
+
+    static constexpr std::size_t s_skipped = std::numeric_limits<std::size_t>::max();
+
+    Visitor&           visitor;
+    std::vector<frame> stack;
+
+    template<typename Node>
+    constexpr void push(Node const& node)
+    {
+        if (node.valid)
+            stack.push_back(frame{.node = &node, .step = &step<Node>, .state = 0});
+    }
+
+    // Pushes the child at index i, if there is one. Returns false if there are no more children.
+    template<typename Node>
+    constexpr auto push_child(Node const& node, std::size_t const i) -> bool
+    {
+        if constexpr (is_seq_node<Node>)
+        {
+            return [&]<std::size_t... is>(std::index_sequence<is...>) constexpr
+            {
+                return ((is == i && (push(node.template get<is>()), true)) || ...);
+            }(std::make_index_sequence<Node::size>{});
+        }
+        else if constexpr (is_alt_node<Node>)
+        {
+            if (i != 0)
+                return false;
+            node.visit([this](auto const& child) { push(child); });
+            return true;
+        }
+        else if constexpr (is_rep_node<Node>)
+        {
+            if (i >= node.size())
+                return false;
+            push(node[i]);
+            return true;
+        }
+        else if constexpr (is_operator_node<Node>) // Operands are visited in input order
+        {
+            if (i >= node.node_operands.size())
+                return false;
+            push(node.node_operands[i]);
+            return true;
+        }
+        else if constexpr (is_nonterminal_node<Node>)
+        {
+            if constexpr (!Node::captured) // Nodes of productions that aren't captured have no children (see capture)
+            {
+                return false;
+            }
+            else
+            {
+                if (i != 0 || !node.nested)
+                    return false;
+                push(*node.nested);
+                return true;
+            }
+        }
+        else
+            return false;
+    }
+
+    template<typename Node>
+    static constexpr auto step(traversal& self, frame& f) -> bool
+    {
+        auto const& node = *static_cast<Node const*>(f.node);
+        if (f.state == 0)
+        {
+            traverse_control const control = call_enter(self.visitor, node);
+            if (control == traverse_control::stop)
+                return false;
+            f.state = control == traverse_control::skip ? s_skipped : 1;
+            return true;
+        }
+        if (f.state != s_skipped)
+        {
+            std::size_t const child = f.state++ - 1;
+            if (self.push_child(node, child)) // Note: invalidates f
+                return true;
+        }
+        self.stack.pop_back(); // Note: invalidates f
+        call_leave(self.visitor, node);
+        return true;
+    }
+
+    template<typename Node>
+    constexpr auto run(Node const& root) -> bool
+    {
+        push(root);
+        while (!stack.empty())
+        {
+            frame& top = stack.back();
+            if (!top.step(*this, top))
+                return false;
+        }
+        return true;
+    }
+};
+} // namespace detail
+
+// Traverses the valid nodes of the parse tree rooted at root in depth-first order
+//
+// The visitor may provide `enter(node)` and `leave(node)` member functions, which are called before and after the
+// children of a node are visited. Alternatively, the visitor may be a callable, which is used in place of `enter`. Both
+// are dispatched at compile time, so they can be overloaded on node kind (e.g. `is_seq_node`) or production
+// (`is_symbol_node<"identifier">`). If `enter` returns a traverse_control, it decides whether the children of the node
+// are visited and whether the traversal continues. `leave` is called for every entered node unless the traversal is
+// stopped.
+//
+// The traversal doesn't recurse, so it is safe to use on arbitrarily deep trees. Returns false iff it was stopped.
+template<typename Node, typename Visitor>
+constexpr auto traverse(Node const& root, Visitor&& visitor) -> bool
+{
+    using visitor_type = std::remove_reference_t<Visitor>;
+    return detail::traversal<visitor_type>{.visitor = visitor, .stack = {}}.run(root);
+}
+} // namespace parsely
+
+#endif // INCLUDE_PARSELY_UTILITY_VISITOR_HPP
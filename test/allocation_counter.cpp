@@ -0,0 +1,37 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+thread_local std::size_t g_allocation_count = 0;
+} // namespace
+
+auto parsely::test::allocation_count() -> std::size_t
+{
+    return g_allocation_count;
+}
+
+auto operator new(std::size_t const size) -> void*
+{
+    ++g_allocation_count;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
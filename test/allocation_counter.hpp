@@ -0,0 +1,32 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#ifndef TEST_ALLOCATION_COUNTER_HPP
+#define TEST_ALLOCATION_COUNTER_HPP
+
+#include <cstddef>
+
+namespace parsely::test
+{
+// Returns the number of calls to the global operator new made by the calling thread so far
+auto allocation_count() -> std::size_t;
+
+// Counts the allocations made by the calling thread during its lifetime
+class allocation_counter
+{
+  public:
+    allocation_counter()
+        : m_start(allocation_count())
+    {
+    }
+
+    [[nodiscard]] auto count() const -> std::size_t { return allocation_count() - m_start; }
+
+  private:
+    std::size_t m_start;
+};
+} // namespace parsely::test
+
+#endif // TEST_ALLOCATION_COUNTER_HPP
@@ -0,0 +1,129 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/runtime/codegen.hpp>
+#include <parsely/runtime/runtime_parser.hpp>
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <expression_parser.hpp> // Generated from expression.peg
+
+#include <concepts>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+using namespace parsely;
+using namespace parsely::runtime;
+
+namespace
+{
+// Same as expression.peg
+constexpr structural::inplace_string expression_grammar = R"raw(
+    expression: term "+" expression | term;
+    term: number | name | "\";
+    number: digit number | digit;
+    digit: 0x30..0x39;
+    name: $letter name | $letter;
+)raw";
+} // namespace
+
+TEST_CASE("generate_source")
+{
+    auto const source = generate_source(expression_grammar, generator_options{.name = "calc", .namespace_name = "ns"});
+    REQUIRE(source.has_value());
+
+    CHECK(source->contains("#ifndef PARSELY_GENERATED_NS_CALC_HPP"));
+    CHECK(source->contains("namespace ns\n"));
+    CHECK(source->contains("struct calc_grammar\n"));
+    CHECK(source->contains("make_production(\"expression\", "));
+    CHECK(source->contains(R"(make_terminal_expr("\\"))"));
+    CHECK(source->contains("inbuilt_letter"));
+    CHECK(source->contains("byte_range{.first = 0x30, .last = 0x39}"));
+    CHECK(source->contains("using calc = parsely::basic_parser<calc_grammar>;"));
+
+    auto const invalid = generate_source("a: b;", generator_options{.name = "invalid"});
+    REQUIRE(!invalid.has_value());
+    CHECK(invalid.error().message.contains("b"));
+
+    CHECK(parsely::runtime::detail::quote("a\n\x7F\"") == R"("a\012\177\"")");
+}
+
+TEST_CASE("generated parser")
+{
+    using test_generated::expression_parser;
+    using static_parser = parser<expression_grammar>;
+
+    SECTION("same results as other parsers")
+    {
+        auto const dynamic = runtime_parser::create(expression_grammar);
+        REQUIRE(dynamic.has_value());
+
+        for (std::string_view const input : {"1", "1+abc", "12+größe+6", "1+", "+1", "", "\\+1", "1+\xFF"})
+        {
+            CAPTURE(input);
+            auto const expected = static_parser::parse(input);
+            auto const actual   = expression_parser::parse(input);
+            CHECK(actual.valid == expected.valid);
+            if (expected.valid)
+            {
+                CHECK(actual.source_text == expected.source_text);
+                CHECK(actual->index() == expected->index());
+            }
+            CHECK(expression_parser::parse_dynamic(input).nodes == dynamic->parse(input).nodes);
+        }
+    }
+
+    SECTION("typed parse tree")
+    {
+        STATIC_CHECK(std::same_as<decltype(expression_parser::parse("")),
+                                  parse_tree_node<expression_parser, parsely::detail::nonterminal_expr{"expression"}>>);
+
+        auto const tree = expression_parser::parse("12+x");
+        REQUIRE(tree);
+        REQUIRE(tree->index() == 0);
+        CHECK(tree->get<0>().source_text == "12+x");
+    }
+
+    SECTION("symbols")
+    {
+        STATIC_CHECK(std::string_view{expression_parser::start_symbol} == "expression");
+        STATIC_CHECK(expression_parser::production_index<"digit"> == 3);
+
+        auto const tree = expression_parser::parse<"number">("42");
+        REQUIRE(tree);
+        CHECK(tree.source_text == "42");
+        CHECK(!expression_parser::parse<"number">("x"));
+        CHECK(expression_parser{}("a+1").valid);
+    }
+
+    SECTION("constexpr")
+    {
+        STATIC_CHECK(expression_parser::parse("1+x").valid);
+        STATIC_CHECK(!expression_parser::parse("1+").valid);
+    }
+
+    SECTION("policies")
+    {
+        using shared_parser = basic_parser<test_generated::expression_parser_grammar, shared_tree<>>;
+
+        auto const result = shared_parser::parse("1+2");
+        auto const copy   = result;
+        REQUIRE(result);
+        CHECK(&*copy == &*result);
+    }
+
+    SECTION("parse_file")
+    {
+        auto const path = std::filesystem::temp_directory_path() / "parsely_test_generated_parser.txt";
+        std::ofstream(path) << "7+seven";
+
+        auto const result = expression_parser::parse_file(path);
+        REQUIRE(result.has_value());
+        CHECK(result->tree().source_text == "7+seven");
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,284 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/runtime/runtime_parser.hpp>
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <string_view>
+
+using namespace parsely;
+using namespace parsely::runtime;
+
+TEST_CASE("runtime_parser")
+{
+    constexpr structural::inplace_string grammar = R"raw(
+        sum: number "+" sum | number;
+        number: digit number | digit;
+        digit: "0" | "1" | "2" | "3" | "4" | "5" | "6" | "7" | "8" | "9";
+    )raw";
+
+    auto const sum_parser = runtime_parser::create(grammar);
+    REQUIRE(sum_parser.has_value());
+
+    SECTION("successful")
+    {
+        auto const tree = sum_parser->parse("12+3");
+        REQUIRE(tree.valid);
+        CHECK(tree.source_text == "12+3");
+        CHECK(sum_parser->symbol(tree.nodes[tree.root()]) == "sum");
+
+        auto const children = tree.children(tree.root());
+        REQUIRE(children.size() == 2);
+        CHECK(sum_parser->symbol(tree.nodes[children[0]]) == "number");
+        CHECK(tree.text(children[0]) == "12");
+        CHECK(sum_parser->symbol(tree.nodes[children[1]]) == "sum");
+        CHECK(tree.text(children[1]) == "3");
+    }
+
+    SECTION("unsuccessful")
+    {
+        CHECK(!sum_parser->parse("x"));
+        CHECK(!sum_parser->parse(""));
+        CHECK(sum_parser->parse("x").nodes.empty());
+    }
+
+    SECTION("symbol")
+    {
+        auto const tree = sum_parser->parse("digit", "7");
+        REQUIRE(tree.valid);
+        CHECK(sum_parser->symbol(tree.nodes[tree.root()]) == "digit");
+        CHECK(!sum_parser->parse("unknown", "7"));
+    }
+
+    SECTION("same results as compile-time parser")
+    {
+        using static_parser = parser<grammar>;
+        for (std::string_view const input : {"1", "1+2", "12+345+6", "1+", "+1", "", "1++2"})
+        {
+            CAPTURE(input);
+            auto const expected = static_parser::parse(input);
+            auto const actual   = sum_parser->parse(input);
+            CHECK(actual.valid == expected.valid);
+            if (expected.valid)
+                CHECK(actual.source_text == expected.source_text);
+        }
+    }
+
+    SECTION("reuse")
+    {
+        dynamic_tree tree;
+        vm           machine;
+        sum_parser->parse_into(tree, machine, "1+2+3");
+        CHECK(tree.valid);
+        CHECK(tree.nodes.size() == 9);
+        sum_parser->parse_into(tree, machine, "4");
+        CHECK(tree.valid);
+        CHECK(tree.nodes.size() == 3);
+    }
+
+    SECTION("constexpr")
+    {
+        constexpr bool valid = []
+        {
+            auto const p = runtime_parser::create(R"raw(list: item "," list | item; item: "a" | "b";)raw");
+            return p.has_value() && p->parse("a,b,a").valid && !p->parse("c").valid;
+        }();
+        STATIC_CHECK(valid);
+    }
+}
+
+TEST_CASE("runtime_parser unicode")
+{
+    auto const identifier_parser = runtime_parser::create(R"raw(
+        identifier: $letter rest;
+        rest: ($letter | $digit | "_") rest | "";
+    )raw");
+    REQUIRE(identifier_parser.has_value());
+
+    CHECK(identifier_parser->parse("größe_2").source_text == "größe_2");
+    CHECK(!identifier_parser->parse("2x"));
+
+    auto const invalid = identifier_parser->parse("ab\xFF");
+    CHECK(!invalid);
+    CHECK(invalid.source_text == "ab");
+
+    auto const any_parser = runtime_parser::create("three: . . .;");
+    REQUIRE(any_parser.has_value());
+    CHECK(any_parser->parse("€a𝄞").source_text == "€a𝄞");
+
+    CHECK(!runtime_parser::create("a: $unknown;"));
+
+    // Only $eoi matches without consuming input, so recursing after it is left recursive
+    CHECK(!runtime_parser::create(R"raw(a: $eoi a | "x";)raw"));
+}
+
+TEST_CASE("runtime_parser bytes")
+{
+    auto const frame_parser = runtime_parser::create(R"raw(
+        frame: 0x7E payload 0x7E;
+        payload: 0x00..0x7D payload | "";
+    )raw");
+    REQUIRE(frame_parser.has_value());
+
+    using namespace std::string_view_literals;
+    CHECK(frame_parser->parse("\x7E\x00\x41\x7E"sv).source_text.size() == 4);
+    CHECK(!frame_parser->parse("\x7E\x7F\x7E"sv));
+
+    auto const hex_parser = runtime_parser::create("start: 0x41 0xface; 0xface: 0x42..0x43;");
+    REQUIRE(hex_parser.has_value());
+    CHECK(hex_parser->parse("AB"));
+    CHECK(!hex_parser->parse("AA"));
+
+    // Strings are matched bytewise, so they may contain invalid UTF-8
+    auto const pair_parser = runtime_parser::create(R"raw(pair: $string ":" $string;)raw");
+    REQUIRE(pair_parser.has_value());
+    CHECK(pair_parser->parse("\"k\\\"\":\"\xFF\""sv).source_text.size() == 9);
+    CHECK(!pair_parser->parse(R"("k":"v)"sv));
+
+    auto const g = load_grammar("a: 0x30..0x39;");
+    REQUIRE(g.has_value());
+    expression const& a = g->expressions[g->productions[0].expression];
+    CHECK(a.kind == expression_kind::char_class);
+    CHECK(a.chars.contains('5'));
+    CHECK(!a.chars.contains('a'));
+}
+
+TEST_CASE("load_grammar")
+{
+    SECTION("structure")
+    {
+        auto const g = load_grammar(R"raw(a: "x" b | (b "y"); b: "z";)raw");
+        REQUIRE(g.has_value());
+        REQUIRE(g->productions.size() == 2);
+        CHECK(g->productions[0].symbol == "a");
+        CHECK(g->productions[1].symbol == "b");
+
+        expression const& a = g->expressions[g->productions[0].expression];
+        CHECK(a.kind == expression_kind::alt);
+        REQUIRE(a.children.size() == 2);
+        CHECK(g->expressions[a.children[0]].kind == expression_kind::seq);
+        CHECK(g->expressions[a.children[1]].kind == expression_kind::seq);
+        CHECK(g->expressions[g->productions[1].expression].text == "z");
+    }
+
+    SECTION("invalid")
+    {
+        CHECK(!load_grammar("a: ;"));
+        CHECK(!load_grammar(R"raw(a: "x")raw"));
+    }
+
+    SECTION("unknown symbol")
+    {
+        auto const g = load_grammar(R"raw(a: "x" b;)raw");
+        REQUIRE(!g);
+        CHECK(g.error().offset == 7);
+    }
+
+    SECTION("duplicate production")
+    {
+        auto const g = load_grammar(R"raw(a: "x"; a: "y";)raw");
+        REQUIRE(!g);
+        CHECK(g.error().offset == 8);
+        CHECK(g.error().location == source_location{.line = 1, .column = 9});
+
+        auto const lines = load_grammar("a: \"x\";\n  a: \"y\";");
+        REQUIRE(!lines);
+        CHECK(lines.error().location == source_location{.line = 2, .column = 3});
+    }
+
+    SECTION("left recursion")
+    {
+        auto const g = load_grammar(R"raw(a: "x" | b "y"; b: a "z";)raw");
+        REQUIRE(!g);
+        CHECK(g.error().offset == 0);
+    }
+
+    SECTION("operator tables")
+    {
+        auto const g = load_grammar(R"raw(e: %operators(d, left "+" "-", right "**" "*"); d: "1" | "2";)raw");
+        REQUIRE(g.has_value());
+
+        expression const& e = g->expressions[g->productions[0].expression];
+        CHECK(e.kind == expression_kind::seq);
+        REQUIRE(e.children.size() == 2);
+        CHECK(g->expressions[e.children[1]].kind == expression_kind::rep);
+
+        auto const p = runtime_parser::create(R"raw(e: %operators(d, left "+" "-", right "*" "**"); d: "1" | "2";)raw");
+        REQUIRE(p.has_value());
+        CHECK(p->parse("1+2**1*2-1").valid);
+        CHECK(p->parse("1+2**1*2-1").source_text == "1+2**1*2-1");
+        CHECK(p->parse("1+").source_text == "1");
+        CHECK(!p->parse("+1"));
+
+        auto const empty = load_grammar(R"raw(e: %operators(d, left "+" ""); d: "1";)raw");
+        REQUIRE(!empty);
+        CHECK(empty.error().message == "Empty operator");
+    }
+}
+
+TEST_CASE("bytecode")
+{
+    SECTION("predictive alternatives")
+    {
+        auto const g = load_grammar(R"raw(a: "x" a | "y" a | "z";)raw");
+        REQUIRE(g.has_value());
+        auto const prog = compile(*g);
+        CHECK(std::ranges::none_of(prog.code, [](instruction const& i) { return i.op == opcode::choice; }));
+    }
+
+    SECTION("char classes")
+    {
+        auto const g = load_grammar(R"raw(digit: "0" | "1" | "2" | "3";)raw");
+        REQUIRE(g.has_value());
+        auto const prog = compile(*g);
+        REQUIRE(prog.sets.size() == 1);
+        CHECK(prog.sets[0].contains('2'));
+        CHECK(!prog.sets[0].contains('4'));
+    }
+}
+
+TEST_CASE("optimize_for_recognition")
+{
+    constexpr std::string_view grammar = R"raw(
+        list: item "," list | item;
+        item: letter item | letter;
+        letter: "a" | "b";
+        words: "x" words | "";
+        loop: "y" loop "z" | "";
+    )raw";
+
+    auto g = load_grammar(grammar);
+    REQUIRE(g.has_value());
+    auto const original = compile(*g);
+    optimize_for_recognition(*g);
+    auto const optimized = compile(*g);
+
+    SECTION("removes calls")
+    {
+        auto const calls = [](program const& prog)
+        { return std::ranges::count_if(prog.code, [](instruction const& i) { return i.op == opcode::call; }); };
+        CHECK(calls(original) == 8);
+        CHECK(calls(optimized) == 1); // Only loop still calls itself
+    }
+
+    SECTION("same results")
+    {
+        vm machine;
+        for (std::string_view const input : {"a", "ab,ba,a", "ab,", ",a", "", "xxx", "xxy", "yyzz", "yyz", "yzz"})
+        {
+            for (std::size_t production = 0; production < g->productions.size(); ++production)
+            {
+                dynamic_tree tree;
+                machine.run(original, production, input, tree);
+                recognition const result = machine.recognize(optimized, production, input);
+                CHECK(result.valid == tree.valid);
+                CHECK(result.length == tree.source_text.size());
+            }
+        }
+    }
+}
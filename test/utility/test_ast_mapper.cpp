@@ -0,0 +1,90 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+using namespace parsely;
+
+namespace
+{
+struct key_value
+{
+    std::string_view key;
+    int              value = 0;
+};
+} // namespace
+
+TEST_CASE("ast_mapper")
+{
+    constexpr structural::inplace_string grammar = R"raw(
+        pairs: pair "," pairs | pair;
+        pair: key "=" number;
+        key: letter key | letter;
+        letter: "a" | "b" | "c";
+        number: digit number | digit;
+        digit: "0" | "1" | "2" | "3" | "4" | "5" | "6" | "7" | "8" | "9";
+    )raw";
+
+    using pair_parser = parser<grammar>;
+
+    static constexpr auto to_int = action<"number", int>(
+        [](std::string_view const text)
+        {
+            int value = 0;
+            for (char const c : text)
+                value = value * 10 + (c - '0');
+            return value;
+        });
+    static constexpr auto to_key_value = action<"pair", key_value>(
+        [](auto const& value) { return key_value{std::get<0>(value).source_text, std::get<2>(value)}; });
+
+    SECTION("mapped productions")
+    {
+        STATIC_CHECK(*pair_parser::map<"number">("123", to_int) == 123);
+        STATIC_CHECK(pair_parser::map<"pair">("abc=12", to_int, to_key_value)->key == "abc");
+        STATIC_CHECK(pair_parser::map<"pair">("abc=12", to_int, to_key_value)->value == 12);
+    }
+
+    SECTION("unmapped productions")
+    {
+        constexpr auto result = []
+        {
+            auto const pairs = pair_parser::map("a=1,bb=22", to_int, to_key_value);
+            auto const& rest = std::get<2>(std::get<0>(**pairs));
+            return std::pair{std::get<0>(std::get<0>(**pairs)).value, std::get<1>(*rest).value};
+        }();
+        STATIC_CHECK(result.first == 1);
+        STATIC_CHECK(result.second == 22);
+
+        STATIC_CHECK(pair_parser::map<"number">("123")->source_text == "123");
+        STATIC_CHECK(pair_parser::map<"number">("123")->symbol == "number");
+        STATIC_CHECK((**pair_parser::map<"number">("123")).index() == 0);
+        STATIC_CHECK((**pair_parser::map<"number">("3")).index() == 1);
+    }
+
+    SECTION("actions run once per parsed production")
+    {
+        int  calls  = 0;
+        auto counted = action<"pair", int>(
+            [&calls](std::string_view /*text*/)
+            {
+                ++calls;
+                return calls;
+            });
+
+        CHECK(pair_parser::map("a=1,b=2,c=3", counted).valid);
+        CHECK(calls == 3);
+    }
+
+    SECTION("unsuccessful")
+    {
+        STATIC_CHECK(!pair_parser::map("=1", to_int, to_key_value));
+        STATIC_CHECK(!pair_parser::map("", to_int, to_key_value));
+        STATIC_CHECK(pair_parser::map("a=1,b=", to_int, to_key_value).valid);
+        STATIC_CHECK(pair_parser::map("a=1,b=", to_int, to_key_value).source_text == "a=1");
+    }
+}
@@ -0,0 +1,174 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include "../allocation_counter.hpp"
+
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using namespace parsely;
+
+namespace
+{
+using list_parser = parser<R"raw(list: item "," list | item; item: "a" "!" | "a" | "b";)raw">;
+
+// Writes events as XML-like tags
+struct event_writer
+{
+    std::string out;
+
+    void enter(std::string_view const symbol)
+    {
+        out += '<';
+        out += symbol;
+        out += '>';
+    }
+
+    void leave(std::string_view const symbol, std::string_view const source_text)
+    {
+        out += "</";
+        out += symbol;
+        out += ':';
+        out += source_text;
+        out += '>';
+    }
+
+    void token(std::string_view const source_text)
+    {
+        out += '\'';
+        out += source_text;
+        out += '\'';
+    }
+};
+
+// Grammar of a list whose items are matched by an inbuilt that counts how often it is called at runtime
+inline std::size_t item_matches = 0;
+
+struct counted_list_parser
+{
+    static constexpr auto s_grammar = detail::make_grammar(
+        detail::make_production("list",
+                                detail::make_alt_expr(detail::make_seq_expr(detail::make_nonterminal_expr("item"),
+                                                                            detail::make_terminal_expr(","),
+                                                                            detail::make_nonterminal_expr("list")),
+                                                      detail::make_nonterminal_expr("item"))),
+        detail::make_production("item",
+                                detail::make_inbuilt_expr("item",
+                                                          [](char const c)
+                                                          {
+                                                              if !consteval
+                                                              {
+                                                                  ++item_matches;
+                                                              }
+                                                              return c == 'a';
+                                                          })));
+};
+
+struct depth_counter
+{
+    std::size_t depth     = 0;
+    std::size_t max_depth = 0;
+
+    constexpr void enter(std::string_view /*symbol*/) { max_depth = std::max(max_depth, ++depth); }
+    constexpr void leave(std::string_view /*symbol*/) { --depth; }
+};
+} // namespace
+
+TEST_CASE("parse_events")
+{
+    SECTION("committed parse only")
+    {
+        event_writer writer;
+        auto const   result = list_parser::parse_events("a!,b", writer);
+
+        CHECK(result.valid);
+        CHECK(result.length == 4);
+        // The failed attempt to match item "," list on "b" isn't reported
+        CHECK(writer.out == "<list><item>'a''!'</item:a!>','<list><item>'b'</item:b></list:b></list:a!,b>");
+    }
+
+    SECTION("no events on failure")
+    {
+        event_writer writer;
+        auto const   result = list_parser::parse_events("c,a", writer);
+
+        CHECK(!result.valid);
+        CHECK(writer.out.empty());
+    }
+
+    SECTION("symbol")
+    {
+        event_writer writer;
+        CHECK(list_parser::parse_events<"item">("b", writer));
+        CHECK(writer.out == "<item>'b'</item:b>");
+    }
+
+    SECTION("partial sinks")
+    {
+        constexpr std::size_t depth = []
+        {
+            depth_counter counter;
+            list_parser::parse_events("a,a!,b", counter);
+            return counter.max_depth;
+        }();
+        STATIC_CHECK(depth == 4);
+    }
+
+    SECTION("uncaptured productions")
+    {
+        using captured_parser = parser<R"raw(list: item "," list | item; item: "a" "!" | "a" | "b";)raw",
+                                       capture<"list">>;
+
+        event_writer writer;
+        CHECK(captured_parser::parse_events("a!,b", writer));
+        CHECK(writer.out == "<list><item></item:a!>','<list><item></item:b></list:b></list:a!,b>");
+    }
+
+    SECTION("input is matched once")
+    {
+        // Alternatives that are recognized before they are emitted would match the rest of the list at every item
+        std::string input = "a";
+        for (std::size_t i = 1; i < 1000; ++i)
+            input += ",a";
+
+        constexpr auto list = detail::make_nonterminal_expr("list");
+
+        depth_counter sink;
+        item_matches      = 0;
+        auto const result = detail::emit_events<counted_list_parser, list>(input, sink);
+
+        CHECK(result.valid);
+        CHECK(result.length == input.size());
+        CHECK(item_matches <= 3 * 1000);
+    }
+
+    SECTION("bounded buffering")
+    {
+        // Once an item matched, the rest of the list can't fail anymore, so its events are reported right away
+        using flat_list_parser = parser<R"raw(list: item rest; rest: "," item rest | ""; item: "a" "!" | "a";)raw">;
+
+        auto const allocations = [](std::size_t const items)
+        {
+            std::string input = "a";
+            for (std::size_t i = 1; i < items; ++i)
+                input += ",a!";
+
+            depth_counter                  sink;
+            test::allocation_counter const counter;
+            bool const                     valid = flat_list_parser::parse_events(input, sink).valid;
+            std::size_t const              count = counter.count();
+            CHECK(valid);
+            return count;
+        };
+
+        CHECK(allocations(1000) == allocations(10));
+    }
+}
@@ -0,0 +1,91 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/grammar_analysis.hpp>
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <string_view>
+
+using namespace parsely;
+using namespace parsely::detail;
+
+TEST_CASE("grammar_analysis")
+{
+    using test_parser = parser<R"raw(
+        sum: digit "+" sum | digit;
+        digit: "0" | "1" | "2";
+        rest: "x" rest | "";
+        word: $letter;
+        list: "(" items ")";
+        items: "a" "," items | "a" | "b";
+    )raw">;
+    using analysis = grammar_analysis<test_parser>;
+    using traits   = grammar_traits<test_parser>;
+
+    SECTION("NULLABLE and FIRST")
+    {
+        constexpr expression_info sum = analysis::productions[traits::production_index<"sum">];
+        STATIC_CHECK(!sum.nullable);
+        STATIC_CHECK(sum.first.contains('1'));
+        STATIC_CHECK(!sum.first.contains('+'));
+
+        constexpr expression_info rest = analysis::productions[traits::production_index<"rest">];
+        STATIC_CHECK(rest.nullable);
+        STATIC_CHECK(rest.first.contains('x'));
+
+        constexpr expression_info word = analysis::productions[traits::production_index<"word">];
+        STATIC_CHECK(!word.nullable);
+        STATIC_CHECK(word.first.contains('a'));
+        STATIC_CHECK(word.first.contains(0xC3)); // Lead byte of non-ASCII letters
+        STATIC_CHECK(!word.first.contains('1'));
+    }
+
+    SECTION("predictive productions")
+    {
+        STATIC_CHECK(analysis::predictive[traits::production_index<"digit">]);
+        STATIC_CHECK(analysis::predictive[traits::production_index<"rest">]);
+        STATIC_CHECK(analysis::predictive[traits::production_index<"list">]);
+        STATIC_CHECK(!analysis::predictive[traits::production_index<"sum">]);
+        STATIC_CHECK(!analysis::predictive[traits::production_index<"items">]);
+
+        constexpr auto backtracking = test_parser::backtracking_productions();
+        STATIC_CHECK(backtracking == std::array<std::string_view, 2>{"sum", "items"});
+        STATIC_CHECK(analysis::backtracking_message() == "Productions that need backtracking: sum items");
+    }
+
+    SECTION("same results as backtracking")
+    {
+        STATIC_CHECK(test_parser::parse<"rest">("xxy").source_text == "xx");
+        STATIC_CHECK(test_parser::parse<"rest">("").valid);
+        STATIC_CHECK(test_parser::parse<"list">("(a,b)").valid);
+        STATIC_CHECK(!test_parser::parse<"list">("(a,c)").valid);
+        STATIC_CHECK(test_parser::parse<"digit">("2").valid);
+        STATIC_CHECK(!test_parser::parse<"digit">("3").valid);
+        STATIC_CHECK(!test_parser::parse<"digit">("").valid);
+
+        auto const tree = test_parser::parse<"digit">("2");
+        REQUIRE(tree.nested);
+        CHECK(tree->get<2>().valid);
+        CHECK(tree->get<2>().source_text == "2");
+    }
+
+    SECTION("require_predictive")
+    {
+        using predictive_parser = parser<R"raw(
+            list: "[" items "]";
+            items: item more | "";
+            more: "," item more | "";
+            item: "a" | "b" | list;
+        )raw",
+                                         require_predictive>;
+
+        STATIC_CHECK(predictive_parser::backtracking_productions().empty());
+        STATIC_CHECK(predictive_parser::parse("[a,[b,a],[]]").source_text == "[a,[b,a],[]]");
+        STATIC_CHECK(!predictive_parser::parse("[a,]"));
+    }
+}
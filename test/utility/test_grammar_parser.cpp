@@ -56,6 +56,37 @@ TEST_CASE("grammar_parser")
         STATIC_CHECK(p.parse<"paren_expr">("(asd | qwe)"));
     }
 
+    SECTION("byte")
+    {
+        STATIC_CHECK(!p.parse<"byte">(""));
+        STATIC_CHECK(!p.parse<"byte">("0x"));
+        STATIC_CHECK(!p.parse<"byte">("0x1"));
+        STATIC_CHECK(!p.parse<"byte">("0xg0"));
+        STATIC_CHECK(p.parse<"byte">("0x1F"));
+        STATIC_CHECK(p.parse<"byte">("0xff"));
+    }
+
+    SECTION("byte_range")
+    {
+        STATIC_CHECK(!p.parse<"byte_range">("0x00"));
+        STATIC_CHECK(!p.parse<"byte_range">("0x00.."));
+        STATIC_CHECK(p.parse<"byte_range">("0x00..0x1F"));
+    }
+
+    SECTION("any_char")
+    {
+        STATIC_CHECK(!p.parse<"any_char">(""));
+        STATIC_CHECK(p.parse<"any_char">("."));
+    }
+
+    SECTION("inbuilt")
+    {
+        STATIC_CHECK(!p.parse<"inbuilt">(""));
+        STATIC_CHECK(!p.parse<"inbuilt">("$"));
+        STATIC_CHECK(!p.parse<"inbuilt">("letter"));
+        STATIC_CHECK(p.parse<"inbuilt">("$letter"));
+    }
+
     SECTION("prim_expr")
     {
         STATIC_CHECK(!p.parse<"prim_expr">(""));
@@ -63,6 +94,11 @@ TEST_CASE("grammar_parser")
         STATIC_CHECK(p.parse<"prim_expr">("\"asd\""));
         STATIC_CHECK(p.parse<"prim_expr">("\"asd\" foo"));
         STATIC_CHECK(p.parse<"prim_expr">("asd foo"));
+        STATIC_CHECK(p.parse<"prim_expr">("."));
+        STATIC_CHECK(p.parse<"prim_expr">("$digit"));
+        STATIC_CHECK(p.parse<"prim_expr">("0x1F").source_text == "0x1F");
+        STATIC_CHECK(p.parse<"prim_expr">("0x00..0x1F").source_text == "0x00..0x1F");
+        STATIC_CHECK(p.parse<"prim_expr">("0xface").source_text == "0xface");
     }
 
     SECTION("seq_expr")
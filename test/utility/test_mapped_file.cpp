@@ -0,0 +1,139 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/mapped_file.hpp>
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+using namespace parsely;
+
+namespace
+{
+// Creates a file with the given contents in the temporary directory and removes it again on destruction
+//
+// A random suffix keeps the names of concurrently running tests apart.
+class temporary_file
+{
+  public:
+    temporary_file(std::string_view const name, std::string_view const contents)
+        : m_path(std::filesystem::temp_directory_path() / unique_name(name))
+    {
+        std::ofstream(m_path, std::ios::binary) << contents;
+    }
+    temporary_file(temporary_file const&)                    = delete;
+    auto operator=(temporary_file const&) -> temporary_file& = delete;
+    ~temporary_file() { std::filesystem::remove(m_path); }
+
+    [[nodiscard]] auto path() const -> std::filesystem::path const& { return m_path; }
+
+  private:
+    static auto unique_name(std::string_view const name) -> std::filesystem::path
+    {
+        std::filesystem::path const path(name);
+        std::string const           suffix = std::to_string(std::random_device{}());
+        return path.stem().string() + '_' + suffix + path.extension().string();
+    }
+
+    std::filesystem::path m_path;
+};
+} // namespace
+
+TEST_CASE("mapped_file")
+{
+    SECTION("regular file")
+    {
+        temporary_file const tmp("parsely_test_mapped_file.txt", "hello world");
+
+        auto file = mapped_file::open(tmp.path());
+        REQUIRE(file.has_value());
+        CHECK(file->text() == "hello world");
+
+        char const* const data  = file->text().data();
+        mapped_file const moved = std::move(*file);
+        CHECK(moved.text().data() == data);
+    }
+
+    SECTION("empty file")
+    {
+        temporary_file const tmp("parsely_test_mapped_file_empty.txt", "");
+
+        auto const file = mapped_file::open(tmp.path());
+        REQUIRE(file.has_value());
+        CHECK(file->text().empty());
+    }
+
+    SECTION("missing file")
+    {
+        auto const file = mapped_file::open(std::filesystem::temp_directory_path() / "parsely_test_missing.txt");
+        REQUIRE(!file);
+        CHECK(file.error() == std::errc::no_such_file_or_directory);
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    SECTION("pipe")
+    {
+        auto const path = std::filesystem::temp_directory_path() / "parsely_test_mapped_file.fifo";
+        std::filesystem::remove(path);
+        REQUIRE(::mkfifo(path.c_str(), 0600) == 0);
+
+        std::thread writer([&] { std::ofstream(path) << "piped"; });
+        auto const  file = mapped_file::open(path);
+        writer.join();
+        std::filesystem::remove(path);
+
+        REQUIRE(file.has_value());
+        CHECK(!file->is_mapped());
+        CHECK(file->text() == "piped");
+    }
+#endif
+}
+
+TEST_CASE("parse_file")
+{
+    using list_parser = parser<R"raw(list: item "," list | item; item: "a" | "b";)raw">;
+
+    SECTION("successful")
+    {
+        temporary_file const tmp("parsely_test_parse_file.txt", "a,b,a");
+
+        auto result = list_parser::parse_file(tmp.path());
+        REQUIRE(result.has_value());
+        REQUIRE(*result);
+        CHECK(result->tree().source_text == "a,b,a");
+        CHECK(result->tree().source_text.data() == result->file().text().data());
+
+        auto const moved = std::move(*result);
+        CHECK(moved.tree().source_text == "a,b,a");
+        CHECK(moved.tree().source_text.data() == moved.file().text().data());
+    }
+
+    SECTION("unsuccessful")
+    {
+        temporary_file const tmp("parsely_test_parse_file_invalid.txt", "a,c");
+
+        auto const result = list_parser::parse_file(tmp.path());
+        REQUIRE(result.has_value());
+        CHECK(!*result);
+    }
+
+    SECTION("missing file")
+    {
+        CHECK(!list_parser::parse_file(std::filesystem::temp_directory_path() / "parsely_test_missing.txt"));
+    }
+}
@@ -0,0 +1,91 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/node_index.hpp>
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <string_view>
+#include <vector>
+
+using namespace parsely;
+
+namespace
+{
+template<typename Nodes>
+auto source_texts(Nodes&& nodes) -> std::vector<std::string_view>
+{
+    std::vector<std::string_view> result;
+    for (auto const& node : nodes)
+        result.push_back(node.source_text);
+    return result;
+}
+} // namespace
+
+TEST_CASE("node_index")
+{
+    using value_parser = parser<R"raw(
+        value: $string | array | number;
+        array: "[" elements "]";
+        elements: value "," elements | value | "";
+        number: digit number | digit;
+        digit: 0x30..0x39;
+    )raw">;
+
+    constexpr std::string_view input = R"([1,["a",22],[3,[4]],"b"])";
+    auto const                 tree  = value_parser::parse(input);
+    REQUIRE(tree.valid);
+
+    node_index<value_parser> const index{tree};
+    CHECK(index.indexes(tree));
+
+    SECTION("all nodes of a production")
+    {
+        // Nested nodes of the same production follow their ancestors
+        CHECK(source_texts(index.all<"array">())
+              == std::vector<std::string_view>{input, R"(["a",22])", "[3,[4]]", "[4]"});
+        CHECK(source_texts(index.all<"number">()) == std::vector<std::string_view>{"1", "22", "2", "3", "4"});
+        CHECK(index.all<"value">().size() == 10);
+        CHECK(index.all<"digit">().size() == 5);
+        CHECK(&index.all<"value">().front() == &tree);
+    }
+
+    SECTION("nodes beginning in a span")
+    {
+        CHECK(source_texts(index.starting_in<"value">({.begin = 10, .end = 17}))
+              == std::vector<std::string_view>{"[3,[4]]", "3", "[4]", "4"});
+        CHECK(source_texts(index.starting_in<"number">({.begin = 8, .end = 9})) == std::vector<std::string_view>{"22"});
+        CHECK(index.starting_in<"array">({.begin = 1, .end = 3}).empty());
+        CHECK(index.starting_in<"array">({.begin = 24, .end = 100}).empty());
+    }
+
+    SECTION("rebuilding")
+    {
+        node_index<value_parser> rebuilt{tree};
+        auto const               other = value_parser::parse("[[],7]");
+        rebuilt.build(other);
+        CHECK(!rebuilt.indexes(tree));
+        CHECK(source_texts(rebuilt.all<"array">()) == std::vector<std::string_view>{"[[],7]", "[]"});
+
+        rebuilt.reset();
+        CHECK(rebuilt.all<"array">().empty());
+        CHECK(node_index<value_parser>{value_parser::parse("[1")}.all<"value">().empty()); // Invalid trees are empty
+    }
+
+    SECTION("error nodes aren't indexed")
+    {
+        using record_parser = parser<R"raw(
+            records: record records | "";
+            record: "a" "\n";
+        )raw",
+                                     recover<"record", "\n">>;
+
+        auto const records = record_parser::parse("a\nb\na\n");
+        REQUIRE(records.valid);
+        CHECK(source_texts(node_index<record_parser>{records}.all<"record">())
+              == std::vector<std::string_view>{"a\n", "a\n"});
+    }
+}
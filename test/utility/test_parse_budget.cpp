@@ -0,0 +1,75 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <string>
+
+using namespace parsely;
+
+TEST_CASE("parse_budget")
+{
+    // Every alternative of expr starts with term, so nested parentheses take exponential time
+    using backtracking_parser = parser<R"raw(
+        expr: term "+" expr | term "-" expr | term;
+        term: "(" expr ")" | "1";
+    )raw">;
+
+    auto const nested = [](std::size_t const depth)
+    { return std::string(depth, '(') + "1" + std::string(depth, ')'); };
+
+    SECTION("within budget")
+    {
+        constexpr parse_budget budget{.max_steps = 10'000, .max_depth = 100, .max_nodes = 1'000};
+
+        auto const result = backtracking_parser::parse("(1+1)-1", budget);
+        REQUIRE(result.has_value());
+        CHECK(result->valid);
+        CHECK(*result == backtracking_parser::parse("(1+1)-1"));
+
+        auto const invalid = backtracking_parser::parse("+1", budget);
+        REQUIRE(invalid.has_value());
+        CHECK(!invalid->valid);
+
+        STATIC_CHECK(backtracking_parser::parse("(1)", budget).has_value());
+    }
+
+    SECTION("steps")
+    {
+        std::string const input  = nested(16);
+        auto const        result = backtracking_parser::parse(input, parse_budget{.max_steps = 1'000});
+        REQUIRE(!result.has_value());
+        CHECK(result.error().limit == budget_limit::steps);
+        CHECK(result.error().offset <= input.size());
+    }
+
+    SECTION("depth")
+    {
+        std::string const input  = nested(16);
+        auto const        result = backtracking_parser::parse(input, parse_budget{.max_depth = 5});
+        REQUIRE(!result.has_value());
+        CHECK(result.error() == budget_exceeded{.limit = budget_limit::depth, .offset = 2});
+
+        CHECK(backtracking_parser::parse(nested(2), parse_budget{.max_depth = 6}).has_value());
+    }
+
+    SECTION("nodes")
+    {
+        auto const result = backtracking_parser::parse("1+1+1+1", parse_budget{.max_nodes = 3});
+        REQUIRE(!result.has_value());
+        CHECK(result.error().limit == budget_limit::nodes);
+
+        CHECK(backtracking_parser::parse("1", parse_budget{.max_nodes = 4}).has_value());
+    }
+
+    SECTION("symbol")
+    {
+        auto const result = backtracking_parser::parse<"term">("(1)", parse_budget{.max_steps = 10});
+        REQUIRE(result.has_value());
+        CHECK(result->source_text == "(1)");
+    }
+}
@@ -0,0 +1,203 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include "../allocation_counter.hpp"
+
+#include <parsely/utility/grammar_parser.hpp>
+#include <parsely/utility/parse_context.hpp>
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <string_view>
+#include <vector>
+
+using namespace parsely;
+
+TEST_CASE("parse_context")
+{
+    using list_parser = parser<R"raw(list: item "," list | item; item: "a" | "b";)raw">;
+
+    SECTION("results")
+    {
+        parse_context<list_parser> context;
+
+        CHECK(context.parse("a,b") == list_parser::parse("a,b"));
+        CHECK(context.parse("b,a,b") == list_parser::parse("b,a,b"));
+        CHECK(context.parse("a") == list_parser::parse("a"));
+        CHECK(context.tree() == list_parser::parse("a"));
+
+        auto const& failed = context.parse("c,a");
+        CHECK(!failed.valid);
+        CHECK(failed.source_text == "");
+    }
+
+    SECTION("symbol")
+    {
+        parse_context<list_parser, "item"> context;
+
+        CHECK(context.parse("b") == list_parser::parse<"item">("b"));
+        CHECK(!context.parse("c"));
+    }
+
+    SECTION("constexpr")
+    {
+        constexpr bool valid = []
+        {
+            parse_context<list_parser> context;
+            context.parse("a,b");
+            return context.parse("b,a").valid;
+        }();
+        STATIC_CHECK(valid);
+    }
+
+    SECTION("no allocations once warmed up")
+    {
+        parse_context<list_parser> context;
+        context.parse("a,b,a");
+
+        test::allocation_counter const counter;
+        bool const                     first  = context.parse("b,a,b").valid;
+        bool const                     failed = context.parse("c,a,b").valid;
+        bool const                     second = context.parse("a,a,a").valid;
+        std::size_t const              count  = counter.count();
+
+        CHECK(first);
+        CHECK(!failed);
+        CHECK(second);
+        CHECK(count == 0);
+    }
+
+    SECTION("no allocations for repetitions once warmed up")
+    {
+        using description_parser = detail::grammar_parser<"foo: bar;">;
+
+        parse_context<description_parser, "grammar"> context;
+        context.parse(R"(a: b "c"; d: e | f;)");
+
+        test::allocation_counter const counter;
+        bool const                     same_shape = context.parse(R"(g: h "i"; j: k | l;)").valid;
+        bool const                     shorter    = context.parse(R"(m: n "o";)").valid;
+        std::size_t const              count      = counter.count();
+
+        CHECK(same_shape);
+        CHECK(shorter);
+        CHECK(count == 0);
+    }
+
+    SECTION("no allocations for structural scans once warmed up")
+    {
+        using string_parser = parser<R"raw(strings: $string "," strings | $string;)raw", structural_scan>;
+
+        parse_context<string_parser> context;
+        context.parse(R"("a","b\"","c")");
+
+        test::allocation_counter const counter;
+        bool const                     same_shape = context.parse(R"("d","e","f\"")").valid;
+        bool const                     failed     = context.parse(R"("g,h)").valid;
+        std::size_t const              count      = counter.count();
+
+        CHECK(same_shape);
+        CHECK(!failed);
+        CHECK(count == 0);
+    }
+}
+
+TEST_CASE("parse_context nodes")
+{
+    using list_parser = parser<R"raw(list: item "," list | item; item: "a" | "b";)raw">;
+
+    parse_context<list_parser> context;
+
+    auto const items = [&]
+    {
+        std::vector<std::string_view> result;
+        for (auto const& item : context.all<"item">())
+            result.push_back(item.source_text);
+        return result;
+    };
+
+    CHECK(context.parse("a,b,a").valid);
+    CHECK(items() == std::vector<std::string_view>{"a", "b", "a"});
+    CHECK(context.all<"list">().size() == 3);
+    CHECK(context.starting_in<"item">({.begin = 1, .end = 4}).size() == 1);
+
+    // The index is rebuilt for each input and for copies of the context
+    CHECK(context.parse("b").valid);
+    CHECK(items() == std::vector<std::string_view>{"b"});
+
+    parse_context<list_parser> copy = context;
+    CHECK(&copy.all<"list">().front() == &copy.tree());
+
+    CHECK(!context.parse("c").valid);
+    CHECK(context.all<"item">().empty());
+}
+
+TEST_CASE("parse_context errors")
+{
+    using record_parser = parser<R"raw(
+        records: record records | "";
+        record: letter letter "\n";
+        letter: 0x61..0x7A;
+    )raw",
+                                 recover<"record", "\n">>;
+
+    parse_context<record_parser> context;
+
+    SECTION("spans of error nodes")
+    {
+        CHECK(context.parse("ab\nabc\ncd\n\nef\n").valid);
+        CHECK(context.errors() == std::vector<source_span>{{3, 7}, {10, 11}});
+
+        CHECK(context.parse("ab\nc").valid);
+        CHECK(context.errors() == std::vector<source_span>{{3, 4}});
+    }
+
+    SECTION("locations of error nodes")
+    {
+        CHECK(context.parse("ab\nabc\ncd\n\nef\n").valid);
+        CHECK(context.error_locations() == std::vector<source_location>{{2, 1}, {4, 1}});
+        CHECK(context.location(12) == source_location{.line = 5, .column = 2});
+
+        CHECK(context.parse("ab\ncd\nx").valid);
+        CHECK(context.error_locations() == std::vector<source_location>{{3, 1}});
+    }
+
+    SECTION("no errors")
+    {
+        CHECK(context.parse("ab\ncd\n").valid);
+        CHECK(context.errors().empty());
+        CHECK(context.error_locations().empty());
+    }
+
+    SECTION("errors inside failed alternatives are discarded")
+    {
+        using nested_parser = parser<R"raw(
+            file: records "!" | records;
+            records: record records | "";
+            record: "a" "\n";
+        )raw",
+                                     recover<"record", "\n">>;
+
+        parse_context<nested_parser> nested;
+        CHECK(nested.parse("a\nb\n").valid);
+        CHECK(nested.errors() == std::vector<source_span>{{2, 4}});
+    }
+
+    SECTION("errors of failed parses are discarded")
+    {
+        using terminated_parser = parser<R"raw(
+            file: records "!";
+            records: record records | "";
+            record: "a" "\n";
+        )raw",
+                                         recover<"record", "\n">>;
+
+        // The records recover from "b\n" before the missing "!" fails the parse
+        parse_context<terminated_parser> terminated;
+        CHECK(!terminated.parse("a\nb\n").valid);
+        CHECK(terminated.errors().empty());
+    }
+}
@@ -3,10 +3,25 @@
 // Copyright (c) 2024 Jan Möller.
 //
 
+#include "../allocation_counter.hpp"
+
+#include <parsely/utility/parse_context.hpp>
 #include <parsely/utility/parser.hpp>
+#include <parsely/utility/visitor.hpp>
 
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 using namespace parsely;
 
 TEST_CASE("parser")
@@ -93,16 +108,16 @@ TEST_CASE("parser")
 
         SECTION("unsuccessful")
         {
+            // Failed parses aren't built, they only report the prefix consumed before failing
             auto result = parse("foobbar");
             CHECK(!result.valid);
             CHECK(result.source_text == "foo");
-            REQUIRE(result.nested);
-            CHECK(result->get<0>().valid);
-            CHECK(result->get<0>().source_text == "foo");
-            CHECK(result->get<0>().terminal == "foo");
-            CHECK(!result->get<1>().valid);
-            CHECK(result->get<1>().source_text == "");
-            CHECK(result->get<1>().terminal == "bar");
+            CHECK(result.nested == nullptr);
+
+            auto first = parse("barfoo");
+            CHECK(!first.valid);
+            CHECK(first.source_text == "");
+            CHECK(first.nested == nullptr);
         }
     }
     SECTION("alternatives")
@@ -123,13 +138,11 @@ TEST_CASE("parser")
         }
         SECTION("unsuccessful")
         {
+            // No alternative is built, not even the one that consumed the most input
             auto result = parse("bam");
             CHECK(!result.valid);
             CHECK(result.source_text == "");
-            REQUIRE(result.nested);
-            CHECK(!result->get<1>().valid);
-            CHECK(result->get<1>().source_text == "");
-            CHECK(result->get<1>().terminal == "bar");
+            CHECK(result.nested == nullptr);
         }
     }
     SECTION("recursive")
@@ -160,26 +173,35 @@ TEST_CASE("parser")
         }
         SECTION("unsuccessful")
         {
+            // The valid nested productions aren't built either
             auto result = parse("(()");
             CHECK(!result.valid);
             CHECK(result.source_text == "(()");
-            REQUIRE(result.nested);
-            CHECK(result->get<0>().valid);
-            CHECK(result->get<0>().source_text == "(");
-            CHECK(result->get<1>().valid);
-            CHECK(result->get<1>().source_text == "()");
-            CHECK(!result->get<2>().valid);
-            CHECK(result->get<2>().source_text == "");
+            CHECK(result.nested == nullptr);
 
-            CHECK(result->get<1>()->get<0>()->get<0>().valid);
-            CHECK(result->get<1>()->get<0>()->get<0>().source_text == "(");
-            CHECK(result->get<1>()->get<0>()->get<1>().valid);
-            CHECK(result->get<1>()->get<0>()->get<1>().source_text == "");
-            CHECK(result->get<1>()->get<0>()->get<2>().valid);
-            CHECK(result->get<1>()->get<0>()->get<2>().source_text == ")");
+            auto unclosed = parse("((");
+            CHECK(!unclosed.valid);
+            CHECK(unclosed.source_text == "(");
+            CHECK(unclosed.nested == nullptr);
         }
     }
 
+    SECTION("shared tree")
+    {
+        using foobar_parser = parser<R"raw(foo: "(" bar ")"; bar : foo | "";)raw", shared_tree<>>;
+
+        constexpr foobar_parser parse;
+
+        auto const result = parse("(())");
+        auto const copy   = result;
+        REQUIRE(result);
+        CHECK(copy == result);
+        CHECK(&*copy == &*result);
+        CHECK(result.nested.use_count() == 2);
+        CHECK(copy->get<1>()->get<0>()->get<1>().source_text == "");
+        STATIC_CHECK(parse("(())") == parse("(())"));
+    }
+
     SECTION("simple calculator")
     {
         constexpr structural::inplace_string grammar = R"raw(
@@ -206,4 +228,371 @@ TEST_CASE("parser")
         CHECK(parse("(1+2)*3"));
         CHECK(parse("-(1+2)*3"));
     }
-}
\ No newline at end of file
+
+    SECTION("unicode")
+    {
+        using identifier_parser = parser<R"raw(
+            identifier: $letter rest;
+            rest: ($letter | $digit | "_") rest | "";
+        )raw">;
+
+        CHECK(identifier_parser::parse("größe_2").source_text == "größe_2");
+        CHECK(identifier_parser::parse("имя٣ rest").source_text == "имя٣");
+        CHECK(!identifier_parser::parse("2x"));
+        CHECK(!identifier_parser::parse(""));
+
+        using any_parser = parser<R"raw(three: . . .;)raw">;
+
+        CHECK(any_parser::parse("€a𝄞").source_text == "€a𝄞");
+        CHECK(!any_parser::parse("€a"));
+        STATIC_CHECK(any_parser::parse("abc"));
+
+        auto const invalid = identifier_parser::parse("ab\xFF");
+        CHECK(!invalid);
+        CHECK(invalid.source_text == "ab");
+    }
+
+    SECTION("binary input")
+    {
+        using frame_parser = parser<R"raw(
+            frame: 0x7E kind payload 0x7E;
+            kind: 0x01 | 0x02;
+            payload: 0x00..0x7D payload | "";
+        )raw",
+                                    input<std::span<std::byte const>>>;
+
+        std::array<std::byte, 5> const bytes{std::byte{0x7E}, std::byte{0x02}, std::byte{0x00}, std::byte{0x41},
+                                             std::byte{0x7E}};
+
+        auto const result = frame_parser::parse(bytes);
+        STATIC_CHECK(std::is_same_v<decltype(result.source_text), std::span<std::byte const>>);
+        REQUIRE(result);
+        CHECK(result.source_text.data() == bytes.data());
+        CHECK(result.source_text.size() == bytes.size());
+        CHECK(std::ranges::equal(result->get<2>().source_text, std::span{bytes}.subspan(2, 2)));
+
+        std::array<std::byte, 3> const bad_kind{std::byte{0x7E}, std::byte{0x03}, std::byte{0x7E}};
+        auto const                     invalid = frame_parser::parse(bad_kind);
+        CHECK(!invalid);
+        CHECK(invalid.source_text.size() == 1);
+
+        using word_parser = parser<R"raw(word: $letter word | $letter;)raw", input<std::u8string_view>>;
+
+        CHECK(word_parser::parse(u8"größe").source_text == u8"größe");
+        CHECK(word_parser::fold(u8"größe").source_text == u8"größe");
+        CHECK(!word_parser::parse(u8"2"));
+
+        // Identifiers that start like byte literals aren't split
+        using hex_parser = parser<R"raw(start: 0x41 0xface; 0xface: 0x42..0x43;)raw">;
+        STATIC_CHECK(hex_parser::parse("AB"));
+        STATIC_CHECK(!hex_parser::parse("AA"));
+    }
+
+    SECTION("no allocations on failure")
+    {
+        using list_parser = parser<R"raw(list: "(" items ")"; items: item "," items | item; item: "a" | "b";)raw">;
+
+        // Failing never builds nodes, so once the decision log has grown, only recording decisions could allocate
+        parse_context<list_parser> context;
+        context.parse("(a,b,a,b,a,b)");
+
+        test::allocation_counter const counter;
+        bool const                     unclosed   = context.parse("(a,b,a,b").valid;
+        bool const                     bad_item   = context.parse("(a,b,c)").valid;
+        bool const                     bad_prefix = context.parse("a,b)").valid;
+        std::size_t const              count      = counter.count();
+
+        CHECK(!unclosed);
+        CHECK(!bad_item);
+        CHECK(!bad_prefix);
+        CHECK(count == 0);
+
+        // Without a context, decisions are only recorded once the input is known to match
+        test::allocation_counter const contextless;
+        bool const                     plain       = list_parser::parse("(a,b,c)").valid;
+        bool const                     budgeted    = list_parser::parse("(a,b,c)", parse_budget{})->valid;
+        std::size_t const              allocations = contextless.count();
+
+        CHECK(!plain);
+        CHECK(!budgeted);
+        CHECK(allocations == 0);
+    }
+
+    SECTION("failed alternatives aren't built")
+    {
+        using foo_parser = parser<R"raw(foo: bar "x" | bar "y"; bar: "b";)raw">;
+
+        auto const allocations = [](std::string_view const input)
+        {
+            test::allocation_counter const counter;
+            bool const                     valid = foo_parser::parse(input).valid;
+            return valid ? counter.count() : 0;
+        };
+        std::size_t const first  = allocations("bx");
+        std::size_t const second = allocations("by");
+
+        CHECK(first > 0);
+        CHECK(second == first);
+    }
+
+    SECTION("recognizing large inputs at compile time")
+    {
+        using config_parser = parser<R"raw(
+            config: entry config | "";
+            entry: key " = " value "
+";
+            key: letter key | letter;
+            letter: 0x61..0x7A | "_";
+            value: number "," value | number;
+            number: digit number | digit;
+            digit: 0x30..0x39;
+        )raw">;
+
+        // Built in its own constant expression, so building it doesn't count towards the limits of recognizing it
+        static constexpr auto input = []
+        {
+            constexpr std::string_view line = "some_key = 12,345,6789\n";
+            std::array<char, line.size() * 4450> result{};
+            for (std::size_t i = 0; i < result.size(); ++i)
+                result[i] = line[i % line.size()];
+            return result;
+        }();
+        constexpr std::string_view text{input.data(), input.size()};
+
+        STATIC_CHECK(config_parser::recognize(text).valid);
+        STATIC_CHECK(config_parser::recognize(text).length == text.size());
+        STATIC_CHECK(config_parser::recognize(text.substr(0, 100)).length == 92);
+        STATIC_CHECK(!config_parser::recognize<"entry">("key = 1,\n"));
+        STATIC_CHECK(config_parser::recognize<"entry">("key = 1,\n").length == 8);
+
+        for (std::string_view const entry : {"a = 1\n", "a_b = 1,2\n", "a = \n", "A = 1\n", "a = 1"})
+        {
+            CHECK(config_parser::recognize<"entry">(entry).valid == config_parser::parse<"entry">(entry).valid);
+            CHECK(config_parser::recognize(entry).length == config_parser::parse(entry).source_text.size());
+        }
+    }
+
+    SECTION("error recovery")
+    {
+        constexpr structural::inplace_string grammar = R"raw(
+            records: record records | "";
+            record: field "," field "\n";
+            field: digit field | digit;
+            digit: 0x30..0x39;
+        )raw";
+        using strict_parser     = parser<grammar>;
+        using recovering_parser = parser<grammar, recover<"record", "\n">>;
+
+        constexpr std::string_view input = "1,2\nx,3\n4,5\n9\n";
+        CHECK(strict_parser::parse(input).source_text == "1,2\n");
+
+        auto const tree = recovering_parser::parse(input);
+        REQUIRE(tree.valid);
+        CHECK(tree.source_text == input);
+
+        auto const& first  = (*tree).get<0>().get<0>();
+        auto const& rest   = (*tree).get<0>().get<1>();
+        auto const& second = rest->get<0>().get<0>();
+        CHECK(first.valid);
+        CHECK(!first.recovered);
+        CHECK(!second.valid);
+        CHECK(second.recovered);
+        CHECK(second.source_text == "x,3\n");
+
+        auto const unterminated = recovering_parser::parse("1,2\n3,");
+        REQUIRE(unterminated.valid);
+        CHECK((*unterminated).get<0>().get<1>()->get<0>().get<0>().source_text == "3,");
+
+        STATIC_CHECK(recovering_parser::parse("x\n1,2\n").valid);
+        STATIC_CHECK(recovering_parser::parse<"record">("").source_text.empty());
+    }
+
+    SECTION("operator tables")
+    {
+        using calc_parser = parser<R"raw(
+            expr: %operators(number, left "+" "-", left "*" "/", right "^" "**");
+            number: digit number | digit;
+            digit: 0x30..0x39;
+        )raw">;
+
+        using node = decltype(calc_parser::parse(""));
+        using expr = std::remove_cvref_t<decltype(*std::declval<node>())>;
+        STATIC_CHECK(expr::operators.size() == 6);
+        STATIC_CHECK(expr::operators[5] == "**");
+
+        auto const tree = calc_parser::parse("1+2*3");
+        REQUIRE(tree.valid);
+        auto const& e = *tree;
+        REQUIRE(e.node_operands.size() == 3);
+        REQUIRE(e.node_operations.size() == 2);
+        CHECK(e.operation(e.root()).source_text == "1+2*3");
+        CHECK(expr::operators[e.operation(e.root()).op] == "+");
+        CHECK(e.operand(e.operation(e.root()).lhs).source_text == "1");
+        CHECK(e.operation(e.operation(e.root()).rhs).source_text == "2*3");
+
+        auto const left = calc_parser::parse("3-2-1");
+        REQUIRE(left.valid);
+        CHECK((*left).operation((*left).root()).lhs == operator_term{.operation = true, .index = 0});
+        CHECK((*left).operation((*left).root()).rhs == operator_term{.index = 2});
+
+        auto const right = calc_parser::parse("2^3**2");
+        REQUIRE(right.valid);
+        CHECK((*right).operation((*right).root()).lhs == operator_term{.index = 0});
+        CHECK((*right).operation((*right).root()).rhs == operator_term{.operation = true, .index = 0});
+        CHECK(expr::operators[(*right).node_operations[0].op] == "**");
+
+        auto const single = calc_parser::parse("42");
+        REQUIRE(single.valid);
+        CHECK((*single).root() == operator_term{});
+        CHECK((*single).node_operations.empty());
+
+        CHECK(calc_parser::parse("1+").source_text == "1");
+        CHECK(!calc_parser::parse("+1"));
+        STATIC_CHECK(calc_parser::parse("1+2*3-4^5").valid);
+        STATIC_CHECK(calc_parser::parse("1*2*").source_text == "1*2");
+    }
+
+    SECTION("dynamic trees")
+    {
+        using sum_parser = parser<R"raw(
+            sum: number "+" sum | number;
+            number: digit number | digit;
+            digit: 0x30..0x39;
+        )raw">;
+
+        STATIC_CHECK(sum_parser::production_index<"number"> == 1);
+
+        auto const tree = sum_parser::parse_dynamic("12+3");
+        REQUIRE(tree.valid);
+        CHECK(tree.source_text == "12+3");
+        CHECK(sum_parser::symbol(tree.nodes[tree.root()]) == "sum");
+        CHECK(tree.nodes.size() == 8);
+
+        auto const children = tree.children(tree.root());
+        REQUIRE(children.size() == 2);
+        CHECK(tree.nodes[children[0]].production == sum_parser::production_index<"number">);
+        CHECK(tree.text(children[0]) == "12");
+        CHECK(tree.text(children[1]) == "3");
+
+        CHECK(sum_parser::parse_dynamic<"digit">("7").nodes.size() == 1);
+        CHECK(sum_parser::parse_dynamic("1+").source_text == sum_parser::parse("1+").source_text);
+        CHECK(!sum_parser::parse_dynamic("+1"));
+        STATIC_CHECK(sum_parser::parse_dynamic("1+2+3").nodes.size() == 9);
+    }
+
+    SECTION("structural scan")
+    {
+        // Elements are matched twice, since the first alternative of elements needs backtracking
+        constexpr structural::inplace_string grammar = R"raw(
+            value: $string | array | "1";
+            array: "[" elements "]";
+            elements: value "," elements | value | "";
+        )raw";
+        using scanning_parser = parser<grammar, structural_scan>;
+        using plain_parser    = parser<grammar>;
+
+        std::string input = R"(["a\"]",["",1,"x\\"],)";
+        for (std::size_t i = 0; i < 100; ++i)
+            input += "\"" + std::string(i, '[') + "\\\"\",";
+        input += "1]";
+
+        auto const tree = scanning_parser::parse(input);
+        REQUIRE(tree.valid);
+        CHECK(tree.source_text == input);
+        CHECK(plain_parser::parse(input).source_text == input);
+
+        auto const& first = (*tree).get<1>()->get<1>()->get<0>().get<0>();
+        CHECK(first.source_text == R"("a\"]")");
+
+        CHECK(scanning_parser::parse(R"(["a"]")").source_text == plain_parser::parse(R"(["a"]")").source_text);
+        CHECK(!scanning_parser::parse(R"(["a)").valid);
+        STATIC_CHECK(scanning_parser::parse(R"(["a\"]",1])").valid);
+    }
+
+    SECTION("hashed tree")
+    {
+        constexpr structural::inplace_string grammar = R"raw(
+            value: $string | array | expr;
+            array: "[" elements "]";
+            elements: value "," elements | value | "";
+            expr: %operators(number, left "+", left "*");
+            number: digit number | digit;
+            digit: 0x30..0x39;
+        )raw";
+        using hashing_parser = parser<grammar, hashed_tree>;
+        STATIC_CHECK(sizeof(decltype(parser<grammar>::parse(""))) < sizeof(decltype(hashing_parser::parse(""))));
+
+        auto const tree = hashing_parser::parse(R"(["a",["a",1+2*3],["a",1+2*3]])");
+        REQUIRE(tree.valid);
+        auto const& rest   = (*tree).get<1>()->get<1>()->get<0>().get<2>();
+        auto const& second = rest->get<0>().get<0>();
+        auto const& third  = rest->get<0>().get<2>()->get<1>();
+        CHECK(second.source_text == R"(["a",1+2*3])");
+        CHECK(third.source_text == R"(["a",1+2*3])");
+        CHECK(second.hash == third.hash);
+        CHECK(second == third);
+
+        // Equal source text of a different production, structure or precedence hashes differently
+        auto const hash = [](std::string_view const input) { return hashing_parser::parse(input).hash; };
+        CHECK(hash(R"(["a",1+2*3])") == second.hash);
+        CHECK(hash(R"(["a",1+2*4])") != second.hash);
+        CHECK(hash(R"(["b",1+2*3])") != second.hash);
+        CHECK(hash(R"(["a"])") != hash(R"([["a"]])"));
+        CHECK(hash("1+2*3") != hash("1*2+3"));
+        CHECK(hash("12") != hash("1"));
+        CHECK(hashing_parser::parse<"number">("12").hash != hash("12"));
+        STATIC_CHECK(hashing_parser::parse("[1,2]").hash == hashing_parser::parse("[1,2]").hash);
+
+        using recovering_parser = parser<R"raw(
+            records: record records | "";
+            record: "1" "\n";
+        )raw", hashed_tree, recover<"record", "\n">>;
+
+        auto const records = recovering_parser::parse("1\nx\n1\ny\n");
+        REQUIRE(records.valid);
+        std::vector<std::uint64_t> hashes;
+        for (auto const* rest = &records; (*rest)->index() == 0; rest = &(*rest)->get<0>().get<1>())
+            hashes.push_back((*rest)->get<0>().get<0>().hash);
+        REQUIRE(hashes.size() == 4);
+        CHECK(hashes[0] == hashes[2]);
+        CHECK(hashes[1] != hashes[0]); // Error nodes
+        CHECK(hashes[1] != hashes[3]);
+    }
+
+    SECTION("capture")
+    {
+        constexpr structural::inplace_string grammar = R"raw(
+            file: line file | "";
+            line: key "=" value "\n";
+            key: letter key | letter;
+            value: digit value | digit;
+            letter: 0x61..0x7A;
+            digit: 0x30..0x39;
+        )raw";
+        using capturing_parser = parser<grammar, capture<"key">>;
+
+        constexpr std::string_view input = "ab=12\nc=3\n";
+        auto const                 tree  = capturing_parser::parse(input);
+        REQUIRE(tree.valid);
+        CHECK(tree.source_text == input);
+
+        // Lines lead to keys, so they are built, while values only keep their source text
+        auto const& line  = (*tree).get<0>().get<0>();
+        auto const& value = line->get<2>();
+        STATIC_CHECK(std::remove_cvref_t<decltype(line)>::captured);
+        STATIC_CHECK(!std::remove_cvref_t<decltype(value)>::captured);
+        CHECK(value.valid);
+        CHECK(value.source_text == "12");
+        CHECK(line->get<0>()->index() == 0);
+        CHECK(line->get<0>()->get<0>().get<0>().source_text == "a");
+
+        std::size_t captured_nodes = 0;
+        std::size_t all_nodes      = 0;
+        traverse(tree, [&](auto const& /*node*/) { ++captured_nodes; });
+        traverse(parser<grammar>::parse(input), [&](auto const& /*node*/) { ++all_nodes; });
+        CHECK(captured_nodes < all_nodes);
+
+        CHECK(!capturing_parser::parse<"line">("a=\n").valid);
+        STATIC_CHECK(capturing_parser::parse("a=1\n").valid);
+    }
+}
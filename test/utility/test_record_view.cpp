@@ -0,0 +1,111 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include "../allocation_counter.hpp"
+
+#include <parsely/utility/parser.hpp>
+#include <parsely/utility/record_view.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+#include <vector>
+
+using namespace parsely;
+
+namespace
+{
+using line_parser = parser<R"raw(
+    line: word "\n";
+    word: letter word | letter;
+    letter: 0x61..0x7A;
+)raw">;
+
+using line_view = record_view<line_parser, "line">;
+
+static_assert(std::ranges::input_range<line_view>);
+static_assert(!std::ranges::forward_range<line_view>);
+static_assert(std::ranges::view<line_view>);
+} // namespace
+
+TEST_CASE("record_view")
+{
+    SECTION("records")
+    {
+        std::vector<std::string_view> lines;
+        for (auto const& line : line_parser::records<"line">("ab\ncde\nf\n"))
+            lines.push_back(line.source_text);
+        CHECK(lines == std::vector<std::string_view>{"ab\n", "cde\n", "f\n"});
+    }
+
+    SECTION("ends at the first mismatch")
+    {
+        auto records = line_parser::records<"line">("ab\n12\ncd\n");
+        auto it      = records.begin();
+        CHECK(it->source_text == "ab\n");
+        ++it;
+        CHECK(it == records.end());
+        CHECK(it.position() == 3);
+        CHECK(records.position() == 3);
+    }
+
+    SECTION("empty input")
+    {
+        auto records = line_parser::records<"line">("");
+        CHECK(records.begin() == records.end());
+    }
+
+    SECTION("single pass")
+    {
+        // All iterators share the tree and position of the view, and begin() starts over
+        auto       records = line_parser::records<"line">("ab\ncd\n");
+        auto const first   = records.begin();
+        auto       second  = first;
+        ++second;
+        CHECK(first->source_text == "cd\n");
+        CHECK(second.position() == 3);
+        CHECK(records.begin()->source_text == "ab\n");
+        CHECK(std::ranges::distance(records) == 2);
+    }
+
+    SECTION("pipelines")
+    {
+        auto const lengths = line_parser::records<"line">("ab\ncde\nf\n")
+                           | std::views::transform([](auto const& line) { return line.source_text.size(); })
+                           | std::views::filter([](std::size_t const length) { return length > 2; });
+        CHECK(std::ranges::equal(lengths, std::vector<std::size_t>{3, 4}));
+    }
+
+    SECTION("error nodes")
+    {
+        using recovering_parser = parser<R"raw(line: letter "\n"; letter: 0x61..0x7A;)raw", recover<"line", "\n">>;
+
+        std::vector<bool> recovered;
+        for (auto const& line : recovering_parser::records("a\n12\nb\n"))
+            recovered.push_back(line.recovered);
+        CHECK(recovered == std::vector<bool>{false, true, false});
+    }
+
+    SECTION("constant memory")
+    {
+        auto records = line_parser::records<"line">("ab\ncd\nef\ngh\n");
+        auto it      = records.begin();
+
+        test::allocation_counter const counter;
+        std::size_t                    count = 0;
+        for (; it != records.end(); ++it)
+            ++count;
+        CHECK(count == 4);
+        CHECK(counter.count() == 0);
+    }
+
+    SECTION("constexpr")
+    {
+        STATIC_CHECK(std::ranges::distance(line_parser::records<"line">("ab\ncd\n")) == 2);
+    }
+}
@@ -0,0 +1,113 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/parser.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+
+using namespace parsely;
+
+namespace
+{
+// Grammar repeating a production that also matches the empty string, which grammar descriptions can't express
+struct optional_item_parser
+{
+    static constexpr auto s_grammar = detail::make_grammar(
+        detail::make_production("list", detail::make_rep_expr(detail::make_nonterminal_expr("item"))),
+        detail::make_production("item",
+                                detail::make_alt_expr(detail::make_terminal_expr("a"), //
+                                                      detail::make_terminal_expr(""))));
+};
+} // namespace
+
+TEST_CASE("semantic_action")
+{
+    constexpr structural::inplace_string grammar = R"raw(
+        sum: number "+" sum | number;
+        number: digit number | digit;
+        digit: "0" | "1" | "2" | "3" | "4" | "5" | "6" | "7" | "8" | "9";
+    )raw";
+
+    using sum_parser = parser<grammar>;
+
+    static constexpr auto to_int = action<"number", int>(
+        [](std::string_view const text)
+        {
+            int value = 0;
+            for (char const c : text)
+                value = value * 10 + (c - '0');
+            return value;
+        });
+    static constexpr auto add = action<"sum", int>(
+        [](auto const& value)
+        {
+            if (value.index() == 0)
+                return std::get<0>(std::get<0>(value)) + std::get<2>(std::get<0>(value));
+            return std::get<1>(value);
+        });
+
+    SECTION("without actions")
+    {
+        STATIC_CHECK(sum_parser::fold("1+2").valid);
+        STATIC_CHECK(*sum_parser::fold("1+2") == "1+2");
+        STATIC_CHECK(!sum_parser::fold("+2"));
+    }
+
+    SECTION("with actions")
+    {
+        STATIC_CHECK(*sum_parser::fold("7", to_int, add) == 7);
+        STATIC_CHECK(*sum_parser::fold("12+30", to_int, add) == 42);
+        STATIC_CHECK(*sum_parser::fold("1+2+3+4", to_int, add) == 10);
+        STATIC_CHECK(*sum_parser::fold<"number">("123", to_int) == 123);
+    }
+
+    SECTION("unsuccessful")
+    {
+        STATIC_CHECK(!sum_parser::fold("x", to_int, add));
+        STATIC_CHECK(!sum_parser::fold("", to_int, add));
+    }
+
+    SECTION("source text")
+    {
+        STATIC_CHECK(sum_parser::fold("12+3+", to_int, add).source_text == "12+3");
+    }
+
+    SECTION("only the committed parse is folded")
+    {
+        // The parse contains the numbers "12" and "2", which the first alternative of sum matches as well before it
+        // fails at the missing "+"
+        int        calls = 0;
+        auto const count = action<"number", int>(
+            [&calls](std::string_view const text)
+            {
+                ++calls;
+                return static_cast<int>(text.size());
+            });
+
+        CHECK(*sum_parser::fold("12", count, add) == 2);
+        CHECK(calls == 2);
+    }
+
+    SECTION("repetitions stop at empty matches")
+    {
+        static constexpr auto count = action<"list", std::size_t>([](auto const& items) { return items.size(); });
+
+        using actions       = std::tuple<decltype(count) const&>;
+        constexpr auto fold = [](std::string_view const input)
+        {
+            return detail::map_expression<optional_item_parser,
+                                          detail::make_nonterminal_expr("list"),
+                                          detail::unmapped_productions::text>(input, actions{count});
+        };
+
+        STATIC_CHECK(fold("aab").source_text == "aa");
+        STATIC_CHECK(*fold("aab") == 2);
+        STATIC_CHECK(*fold("b") == 0);
+    }
+}
@@ -0,0 +1,99 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/shared_indirect.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace parsely;
+
+TEST_CASE("shared_indirect")
+{
+    SECTION("construction")
+    {
+        shared_indirect<int> i0;
+        shared_indirect<int> i1 = shared_indirect<int>(nullptr);
+        shared_indirect<int> i2 = 42;
+        shared_indirect<int> i3 = shared_indirect<int>(std::in_place, 42);
+        CHECK(!i0);
+        CHECK(!i1);
+        CHECK(i2 == 42);
+        CHECK(i3 == 42);
+        CHECK(i0.use_count() == 0);
+        CHECK(i2.use_count() == 1);
+    }
+    SECTION("copies share the value")
+    {
+        shared_indirect<int> const i0 = 42;
+        shared_indirect<int>       i1 = i0;
+        CHECK(&*i0 == &*i1);
+        CHECK(i0.use_count() == 2);
+
+        i1 = nullptr;
+        CHECK(!i1);
+        CHECK(i0.use_count() == 1);
+    }
+    SECTION("assignment")
+    {
+        shared_indirect<int> i0;
+        shared_indirect<int> i1 = 42;
+        shared_indirect<int> i2 = 0;
+
+        i0 = i1;
+        i2 = std::move(i1);
+
+        CHECK(i0 == 42);
+        CHECK(i1 == nullptr);
+        CHECK(i2 == 42);
+        CHECK(i0.use_count() == 2);
+    }
+    SECTION("swap")
+    {
+        shared_indirect<int> i0;
+        shared_indirect<int> i1 = 42;
+
+        i0.swap(i1);
+
+        CHECK(i0 == 42);
+        CHECK(i1 == nullptr);
+    }
+    SECTION("thread safe")
+    {
+        shared_indirect<int, true> const i0 = 42;
+        std::atomic<int>                 mismatches = 0;
+        {
+            std::vector<std::jthread> threads;
+            for (int t = 0; t < 4; ++t)
+            {
+                threads.emplace_back(
+                    [&]
+                    {
+                        for (int i = 0; i < 1000; ++i)
+                        {
+                            auto const copy = i0;
+                            if (*copy != 42)
+                                ++mismatches;
+                        }
+                    });
+            }
+        }
+        CHECK(mismatches == 0);
+        CHECK(i0.use_count() == 1);
+    }
+    SECTION("constexpr")
+    {
+        STATIC_CHECK(
+            []
+            {
+                shared_indirect<int> i0 = 42;
+                auto const           i1 = i0;
+                return i0.use_count() == 2 && i1 == 42;
+            }());
+    }
+}
@@ -0,0 +1,130 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/source_index.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using namespace parsely;
+
+TEST_CASE("source_index")
+{
+    SECTION("locations")
+    {
+        source_index index{std::string_view{"ab\ncd\n\nef"}};
+        CHECK(index.location(0) == source_location{.line = 1, .column = 1});
+        CHECK(index.location(2) == source_location{.line = 1, .column = 3}); // The newline ends its line
+        CHECK(index.location(3) == source_location{.line = 2, .column = 1});
+        CHECK(index.location(6) == source_location{.line = 3, .column = 1});
+        CHECK(index.location(8) == source_location{.line = 4, .column = 2});
+        CHECK(index.location(9) == source_location{.line = 4, .column = 3});
+        CHECK(index.location(100) == source_location{.line = 4, .column = 3}); // Past the end
+    }
+
+    SECTION("lines")
+    {
+        source_index index{std::string_view{"ab\r\ncd\n\nef"}};
+        CHECK(index.line_count() == 4);
+        CHECK(index.line(1) == "ab\r");
+        CHECK(index.line(2) == "cd");
+        CHECK(index.line(3).empty());
+        CHECK(index.line(4) == "ef");
+
+        source_index trailing{std::string_view{"ab\n"}};
+        CHECK(trailing.line_count() == 2);
+        CHECK(trailing.line(2).empty());
+
+        source_index empty{std::string_view{}};
+        CHECK(empty.line_count() == 1);
+        CHECK(empty.location(0) == source_location{});
+    }
+
+    SECTION("columns count codepoints")
+    {
+        std::string_view const input = "héllo\n€𝄞x";
+        source_index           index{input};
+        CHECK(index.location(input.find('l')) == source_location{.line = 1, .column = 3});
+        CHECK(index.location(input.find('x')) == source_location{.line = 2, .column = 3});
+        CHECK(index.location(input.substr(input.find('x'))) == source_location{.line = 2, .column = 3});
+
+        source_index chars{std::u8string_view{u8"é\né"}};
+        CHECK(chars.location(5) == source_location{.line = 2, .column = 2});
+    }
+
+    SECTION("reset")
+    {
+        std::string_view const first  = "a\nb";
+        std::string_view const second = "a\n\n\nb";
+        source_index           index{first};
+        CHECK(index.location(2) == source_location{.line = 2, .column = 1});
+        index.reset(second);
+        CHECK(index.location(4) == source_location{.line = 4, .column = 1});
+    }
+
+    SECTION("constexpr")
+    {
+        STATIC_CHECK(source_index{std::string_view{"a\nbc"}}.location(3) == source_location{.line = 2, .column = 2});
+        STATIC_CHECK(source_index{std::string_view{"a\nb\n"}}.line_count() == 3);
+    }
+
+    SECTION("large inputs")
+    {
+        // Lines of varying length, so newlines fall on every position of the blocks that are scanned at once
+        std::string input;
+        for (std::size_t i = 0; i < 1000; ++i)
+            input += std::string(i % 37, 'x') + '\n';
+        input += "end";
+
+        source_index index{input};
+        CHECK(index.line_count() == 1001);
+
+        std::size_t line   = 1;
+        std::size_t column = 1;
+        for (std::size_t offset = 0; offset < input.size(); ++offset)
+        {
+            if (offset % 7 == 0)
+                CHECK(index.location(offset) == source_location{.line = line, .column = column});
+            if (input[offset] == '\n')
+            {
+                ++line;
+                column = 1;
+            }
+            else
+            {
+                ++column;
+            }
+        }
+        CHECK(index.line(1001) == "end");
+        CHECK(index.line(38) == std::string(0, 'x'));
+        CHECK(index.line(40) == std::string(2, 'x'));
+    }
+
+    SECTION("long lines")
+    {
+        // Columns on lines longer than the checkpoint interval are counted from the checkpoints
+        std::string input = "é\n";
+        for (std::size_t i = 0; i < 3 * source_index::checkpoint_interval; ++i)
+            input += i % 5 == 0 ? "€" : "x";
+        input += "\nend";
+
+        source_index index{input};
+        CHECK(index.line_count() == 3);
+
+        std::size_t column = 1;
+        for (std::size_t offset = 3; offset < input.size() - 4; ++offset)
+        {
+            if (offset % 11 == 0)
+                CHECK(index.location(offset) == source_location{.line = 2, .column = column});
+            column += (static_cast<unsigned char>(input[offset]) & 0xC0) != 0x80 ? 1 : 0;
+        }
+        CHECK(index.location(input.size() - 4) == source_location{.line = 2, .column = column});
+        CHECK(index.location(input.size() - 1) == source_location{.line = 3, .column = 3});
+        CHECK(index.location(1) == source_location{.line = 1, .column = 2});
+    }
+}
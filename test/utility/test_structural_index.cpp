@@ -0,0 +1,105 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/structural_index.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <string>
+
+using namespace parsely;
+
+TEST_CASE("structural_index")
+{
+    constexpr std::size_t npos = structural_index::npos;
+
+    SECTION("quoted strings")
+    {
+        STATIC_CHECK(match_quoted_string(R"("")") == 2);
+        STATIC_CHECK(match_quoted_string(R"("ab" "c")") == 4);
+        STATIC_CHECK(match_quoted_string(R"("a\"b")") == 6);
+        STATIC_CHECK(match_quoted_string(R"("a\\" b")") == 5);
+        STATIC_CHECK(!match_quoted_string(R"(a")"));
+        STATIC_CHECK(!match_quoted_string(R"("a\")"));
+        STATIC_CHECK(!match_quoted_string(R"("a)"));
+
+        // Long enough to be scanned in blocks, with escapes on both sides of block boundaries
+        std::string input = "\"";
+        for (std::size_t i = 0; i < 100; ++i)
+            input += i % 7 == 0 ? "\\\"" : "x";
+        input += "\" tail";
+        CHECK(match_quoted_string(input) == input.size() - 5);
+    }
+
+    SECTION("strings")
+    {
+        structural_index index{R"("a" "b\"c" "d\\")"};
+        CHECK(index.size() == 6);
+        CHECK(index.closing_quote(0) == 2);
+        CHECK(index.closing_quote(4) == 9);
+        CHECK(index.closing_quote(11) == 15);
+        CHECK(index.closing_quote(2) == npos); // Closing quotes don't open strings
+        CHECK(index.closing_quote(7) == npos); // Escaped quotes aren't indexed
+        CHECK(index.closing_quote(1) == npos);
+
+        structural_index unterminated{R"("a" "b)"};
+        CHECK(unterminated.closing_quote(0) == 2);
+        CHECK(unterminated.closing_quote(4) == npos);
+    }
+
+    SECTION("brackets")
+    {
+        structural_index index{R"([{"]"}, [], ("x"]])", "[]{}"};
+        CHECK(index.matching_bracket(0) == 16);
+        CHECK(index.matching_bracket(16) == 0);
+        CHECK(index.matching_bracket(1) == 5);
+        CHECK(index.matching_bracket(8) == 9);
+        CHECK(index.matching_bracket(3) == npos);  // Inside of a string
+        CHECK(index.matching_bracket(11) == npos); // Not a bracket of the index
+        CHECK(index.matching_bracket(17) == npos); // Mismatched
+        CHECK(index.closing_quote(2) == 4);
+
+        STATIC_CHECK(structural_index{R"(["a]", {"b\\"}])", "[]{}"}.matching_bracket(0) == 14);
+    }
+
+    SECTION("large inputs")
+    {
+        // Strings and escapes of varying length, so they cross the boundaries of the blocks that are classified at once
+        std::string input = "[";
+        for (std::size_t i = 0; i < 200; ++i)
+            input += "{\"" + std::string(i % 13, '[') + std::string(2 * (i % 3), '\\') + "\"},";
+        input += "{}]";
+
+        structural_index index{input, "[]{}"};
+        CHECK(index.matching_bracket(0) == input.size() - 1);
+
+        std::size_t offset = 1;
+        for (std::size_t i = 0; i < 200; ++i)
+        {
+            std::size_t const length = i % 13 + 2 * (i % 3) + 2;
+            CHECK(index.closing_quote(offset + 1) == offset + length);
+            CHECK(index.matching_bracket(offset) == offset + length + 1);
+            offset += length + 3;
+        }
+
+        // The escape of the quote at the start of the second block is carried over from the first one
+        structural_index escaped{std::string(62, 'x') + R"("\"b")"};
+        CHECK(escaped.size() == 2);
+        CHECK(escaped.closing_quote(62) == 66);
+    }
+
+    SECTION("reset")
+    {
+        structural_index index{R"(["a", "b"])", "[]"};
+        CHECK(index.closing_quote(6) == 8);
+
+        index.reset(R"("c" [)");
+        CHECK(index.size() == 2);
+        CHECK(index.closing_quote(0) == 2);
+        CHECK(index.closing_quote(6) == npos);
+        CHECK(index.matching_bracket(4) == npos); // Brackets aren't indexed unless requested
+    }
+}
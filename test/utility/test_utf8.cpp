@@ -0,0 +1,72 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/utf8.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <string>
+
+using namespace parsely;
+
+TEST_CASE("utf8")
+{
+    SECTION("decode")
+    {
+        STATIC_CHECK(decode_utf8("a")->value == U'a');
+        STATIC_CHECK(decode_utf8("é")->value == U'é');
+        STATIC_CHECK(decode_utf8("é")->length == 2);
+        STATIC_CHECK(decode_utf8("€")->length == 3);
+        STATIC_CHECK(decode_utf8("𝄞")->value == U'𝄞');
+        STATIC_CHECK(decode_utf8("𝄞")->length == 4);
+        STATIC_CHECK(!decode_utf8(""));
+        STATIC_CHECK(!decode_utf8("\x80"));             // Continuation byte
+        STATIC_CHECK(!decode_utf8("\xC3"));             // Truncated
+        STATIC_CHECK(!decode_utf8("\xC0\x80"));         // Overlong
+        STATIC_CHECK(!decode_utf8("\xED\xA0\x80"));     // Surrogate
+        STATIC_CHECK(!decode_utf8("\xF4\x90\x80\x80")); // Beyond U+10FFFF
+    }
+
+    SECTION("validate")
+    {
+        STATIC_CHECK(is_valid_utf8(""));
+        STATIC_CHECK(is_valid_utf8("héllo wörld €𝄞"));
+        STATIC_CHECK(!is_valid_utf8("ab\xFF"));
+        STATIC_CHECK(valid_utf8_prefix("ab\xFF") == 2);
+
+        // Long enough to take the block-wise ASCII path
+        std::string input(1000, 'a');
+        input += "é";
+        input += std::string(37, 'b');
+        CHECK(is_valid_utf8(input));
+        input += "\xFF";
+        CHECK(valid_utf8_prefix(input) == input.size() - 1);
+        input.insert(500, "\xC3");
+        CHECK(valid_utf8_prefix(input) == 500);
+    }
+
+    SECTION("classes")
+    {
+        STATIC_CHECK(is_letter(U'a'));
+        STATIC_CHECK(is_letter(U'é'));
+        STATIC_CHECK(is_letter(U'ж'));
+        STATIC_CHECK(is_letter(U'中'));
+        STATIC_CHECK(!is_letter(U'1'));
+        STATIC_CHECK(!is_letter(U'€'));
+        STATIC_CHECK(is_decimal_digit(U'7'));
+        STATIC_CHECK(is_decimal_digit(U'٣'));
+        STATIC_CHECK(!is_decimal_digit(U'x'));
+        STATIC_CHECK(is_white_space(U' '));
+        STATIC_CHECK(is_white_space(U'　'));
+        STATIC_CHECK(!is_white_space(U'_'));
+    }
+
+    SECTION("match")
+    {
+        STATIC_CHECK(match_codepoint<is_letter>("über") == 2);
+        STATIC_CHECK(!match_codepoint<is_letter>("1"));
+        STATIC_CHECK(!match_codepoint<is_codepoint>(""));
+    }
+}
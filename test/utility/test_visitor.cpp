@@ -0,0 +1,128 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+
+#include <parsely/utility/parser.hpp>
+#include <parsely/utility/visitor.hpp>
+
+#include <catch2/catch_all.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace parsely;
+
+namespace
+{
+struct symbol_recorder
+{
+    std::vector<std::string_view> entered;
+    std::vector<std::string_view> left;
+
+    void enter(is_nonterminal_node auto const& node) { entered.push_back(node.symbol); }
+    void leave(is_nonterminal_node auto const& node) { left.push_back(node.symbol); }
+};
+} // namespace
+
+TEST_CASE("visitor")
+{
+    using list_parser = parser<R"raw(list: item "," list | item; item: "a" | "b";)raw">;
+
+    SECTION("pre- and post-order")
+    {
+        auto const tree = list_parser::parse("a,b");
+        REQUIRE(tree);
+
+        symbol_recorder recorder;
+        CHECK(traverse(tree, recorder));
+        CHECK(recorder.entered == std::vector<std::string_view>{"list", "item", "list", "item"});
+        CHECK(recorder.left == std::vector<std::string_view>{"item", "item", "list", "list"});
+    }
+
+    SECTION("terminals")
+    {
+        auto const tree = list_parser::parse("a,b,a");
+        REQUIRE(tree);
+
+        std::string terminals;
+        traverse(tree,
+                 [&]<typename Node>(Node const& node)
+                 {
+                     if constexpr (is_terminal_node<Node>)
+                         terminals += node.source_text;
+                 });
+        CHECK(terminals == "a,b,a");
+    }
+
+    SECTION("skip")
+    {
+        auto const tree = list_parser::parse("a,b,a");
+        REQUIRE(tree);
+
+        std::size_t items     = 0;
+        std::size_t terminals = 0;
+        CHECK(traverse(tree,
+                       [&]<typename Node>(Node const& /*node*/) -> traverse_control
+                       {
+                           if constexpr (is_symbol_node<Node, "item">)
+                           {
+                               ++items;
+                               return traverse_control::skip;
+                           }
+                           else if constexpr (is_terminal_node<Node>)
+                               ++terminals;
+                           return traverse_control::descend;
+                       }));
+        CHECK(items == 3);
+        CHECK(terminals == 2);
+    }
+
+    SECTION("stop")
+    {
+        auto const tree = list_parser::parse("a,b,a");
+        REQUIRE(tree);
+
+        std::size_t items = 0;
+        CHECK(!traverse(tree,
+                        [&]<typename Node>(Node const& /*node*/) -> traverse_control
+                        {
+                            if constexpr (is_symbol_node<Node, "item">)
+                            {
+                                if (++items == 2)
+                                    return traverse_control::stop;
+                            }
+                            return traverse_control::descend;
+                        }));
+        CHECK(items == 2);
+    }
+
+    SECTION("deep tree")
+    {
+        std::string input = "a";
+        for (std::size_t i = 1; i < 1000; ++i)
+            input += ",b";
+
+        auto const tree = list_parser::parse(input);
+        REQUIRE(tree);
+
+        symbol_recorder recorder;
+        CHECK(traverse(tree, recorder));
+        CHECK(recorder.entered.size() == 2000);
+        CHECK(recorder.left.size() == 2000);
+        CHECK(recorder.left.back() == "list");
+    }
+
+    SECTION("constexpr")
+    {
+        constexpr auto count = []
+        {
+            std::size_t nodes = 0;
+            traverse(list_parser::parse("a,b"), [&](auto const& /*node*/) { ++nodes; });
+            return nodes;
+        }();
+        // list > alt > seq > (item > alt > "a", ",", list > alt > item > alt > "b")
+        STATIC_CHECK(count == 12);
+    }
+}
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+#
+# Elvis Parsely
+# Copyright (c) 2025 Jan Möller.
+#
+# Generates include/parsely/utility/unicode_tables.hpp from the Unicode database bundled with Python.
+#
+# Usage: tools/generate_unicode_tables.py > include/parsely/utility/unicode_tables.hpp
+
+import sys
+import unicodedata
+
+# White_Space isn't exposed by unicodedata; these are the codepoints listed in PropList.txt
+WHITE_SPACE = [0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x20, 0x85, 0xA0, 0x1680, *range(0x2000, 0x200B), 0x2028, 0x2029, 0x202F,
+               0x205F, 0x3000]
+
+
+def ranges(predicate):
+    result = []
+    for cp in range(sys.maxunicode + 1):
+        if not predicate(cp):
+            continue
+        if result and result[-1][1] == cp - 1:
+            result[-1][1] = cp
+        else:
+            result.append([cp, cp])
+    return result
+
+
+def emit(name, comment, table):
+    print(f"// {comment}")
+    print(f"inline constexpr std::array<codepoint_range, {len(table)}> {name} = {{{{")
+    for first, last in table:
+        print(f"    {{0x{first:04X}, 0x{last:04X}}},")
+    print("}};")
+
+
+def category(prefix):
+    return lambda cp: unicodedata.category(chr(cp)).startswith(prefix)
+
+
+print(f"""//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+// Generated by tools/generate_unicode_tables.py from Unicode {unicodedata.unidata_version}. Do not edit.
+//
+
+#ifndef INCLUDE_PARSELY_UTILITY_UNICODE_TABLES_HPP
+#define INCLUDE_PARSELY_UTILITY_UNICODE_TABLES_HPP
+
+#include <array>
+
+namespace parsely::detail
+{{
+// An inclusive range of codepoints
+struct codepoint_range
+{{
+    char32_t first;
+    char32_t last;
+}};
+""")
+emit("letter_ranges", "Codepoints of general category L (letters)", ranges(category("L")))
+print()
+emit("decimal_digit_ranges", "Codepoints of general category Nd (decimal digits)", ranges(category("Nd")))
+print()
+emit("white_space_ranges", "Codepoints with the White_Space property", ranges(lambda cp: cp in WHITE_SPACE))
+print("""} // namespace parsely::detail
+
+#endif // INCLUDE_PARSELY_UTILITY_UNICODE_TABLES_HPP""")
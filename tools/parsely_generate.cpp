@@ -0,0 +1,68 @@
+//
+// Elvis Parsely
+// Copyright (c) 2025 Jan Möller.
+//
+// Generates a C++ header defining a parser for a grammar file, so the grammar description doesn't have to be parsed by
+// every translation unit that uses it.
+//
+// Usage: parsely_generate <grammar file> <output header> <parser name> [<namespace>]
+//
+
+#include <parsely/runtime/codegen.hpp>
+#include <parsely/runtime/grammar.hpp>
+#include <parsely/utility/mapped_file.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+// Prints error in the format used by compilers
+void report_error(std::filesystem::path const& path, parsely::runtime::grammar_error const& error)
+{
+    std::cerr << path.string() << ':' << error.location.line << ':' << error.location.column
+              << ": error: " << error.message << '\n';
+}
+} // namespace
+
+auto main(int const argc, char const* const* const argv) -> int
+{
+    if (argc < 4 || argc > 5)
+    {
+        std::cerr << "Usage: parsely_generate <grammar file> <output header> <parser name> [<namespace>]\n";
+        return 2;
+    }
+    std::filesystem::path const grammar_path = argv[1];
+    std::filesystem::path const output_path  = argv[2];
+
+    auto const file = parsely::mapped_file::open(grammar_path);
+    if (!file)
+    {
+        std::cerr << grammar_path.string() << ": error: " << file.error().message() << '\n';
+        return 1;
+    }
+
+    auto const source = parsely::runtime::generate_source(file->text(),
+                                                          parsely::runtime::generator_options{
+                                                              .name           = argv[3],
+                                                              .namespace_name = argc == 5 ? argv[4] : "",
+                                                              .source         = grammar_path.filename().string(),
+                                                          });
+    if (!source)
+    {
+        report_error(grammar_path, source.error());
+        return 1;
+    }
+
+    // The output is always written, even if it is unchanged, so build systems see it as up to date afterwards
+    std::ofstream output(output_path, std::ios::binary | std::ios::trunc);
+    output << *source;
+    if (!output.flush())
+    {
+        std::cerr << output_path.string() << ": error: Could not write the generated parser\n";
+        return 1;
+    }
+    return 0;
+}